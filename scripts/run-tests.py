@@ -4,36 +4,104 @@
 Run tests.
 Each test file is paired with a value of whether it should pass or not.
 
+A test can also say what the build should make: "run" is the exit status of
+the compiled program, and "files" lists files the build writes, with strings
+each must ("has") or mustn't ("lacks") contain, or whether it should exist at
+all ("exists"). Such tests are built in a copy of their own, so nothing is
+left next to them.
+
+An index with "project": true is for the project in its own directory - each
+test builds it with --project and the test's own flags.
+
 The path to yfc should be provided as command-line argument, else, 
 `./cmake/yfc` will be used.
 """
 
 import json
 import os, os.path
+import shutil
 import subprocess
 import sys
+import tempfile
 
 tests = []
 
-def add_test(test, flags, pass_):
-    tests.append( (test, flags, pass_) )
+def add_test(test, flags, pass_, expect=None, project=False):
+    tests.append( (test, flags, pass_, expect or {}, project) )
 
 yfc_path = sys.argv[1] if len(sys.argv) > 1 else "./cmake/yfc"
+
+def run_quietly(args, cwd=None):
+    return subprocess.call(args, cwd=cwd,
+        stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, stdin=subprocess.DEVNULL)
+
+def check_files(workdir, files):
+    """
+    Check the files a build made. Returns what's wrong, or None.
+    """
+    for path, want in files.items():
+        full = os.path.join(workdir, path)
+        if not want.get('exists', True):
+            if os.path.exists(full):
+                return f"{path} exists"
+            continue
+        if not os.path.exists(full):
+            return f"{path} is missing"
+        with open(full) as f:
+            text = f.read()
+        for needle in want.get('has', []):
+            if needle not in text:
+                return f"{path} doesn't have {needle!r}"
+        for needle in want.get('lacks', []):
+            if needle in text:
+                return f"{path} has {needle!r}"
+    return None
+
+def run_checked(test, flags, pass_, expect, project):
+    """
+    Build a test in a temporary directory and check what it made. Returns
+    what's wrong, or None.
+    """
+    with tempfile.TemporaryDirectory() as tmp:
+        if project:
+            name = os.path.basename(os.path.normpath(test))
+            workdir = os.path.join(tmp, name)
+            shutil.copytree(os.path.join(test, "src"), os.path.join(workdir, "src"))
+            args = ("--project", *flags)
+            program = name
+        else:
+            workdir = tmp
+            shutil.copy(test, workdir)
+            args = (*flags, os.path.basename(test))
+            program = "a.out"
+        success = run_quietly( (os.path.abspath(yfc_path), *args), workdir) == 0
+        if success != pass_:
+            return "yfc " + ("failed" if pass_ else "passed")
+        if 'run' in expect:
+            status = run_quietly( (os.path.join(workdir, program),), workdir)
+            if status != expect['run']:
+                return f"the program exited with {status}, not {expect['run']}"
+        return check_files(workdir, expect.get('files', {}))
+
 def run_tests():
 
     total = passed = failed = 0
     failed_files = []
 
-    for test, flags, pass_ in tests:
-        retcode = subprocess.call( (yfc_path, *flags, test),
-            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, stdin=subprocess.DEVNULL)
-        success = retcode == 0
-        if (success != pass_):
-            print(f"\033[91mFAIL: {test}\033[0m")
+    for test, flags, pass_, expect, project in tests:
+        if expect or project:
+            problem = run_checked(test, flags, pass_, expect, project)
+        else:
+            retcode = run_quietly( (yfc_path, *flags, test) )
+            success = retcode == 0
+            problem = "yfc " + ("failed" if pass_ else "passed") if success != pass_ else None
+        name = " ".join( (test, *flags) ) if project else test
+        if problem:
+            print(f"\033[91mFAIL: {name}: {problem}\033[0m")
             failed += 1
-            failed_files.append(test)
+            failed_files.append(name)
         else:
-            print(f"\033[92mPass: {test}\033[0m")
+            print(f"\033[92mPass: {name}\033[0m")
             passed += 1
         total += 1
 
@@ -45,7 +113,6 @@ def run_tests():
         return 1
     return 0
 
-# TODO - more detailed result checking than just "pass/fail"
 test_dir = "tests"
 def main():
 
@@ -61,12 +128,14 @@ def main():
         with open(os.path.join(dir.path, "index.json")) as f:
             index = json.load(f)
         flags = index['flags'] if 'flags' in index else []
+        project = index.get('project', False)
         for unit, sig in index['tests'].items():
-            testfile = os.path.join(dir.path, unit + '.yf')
+            testfile = dir.path if project else os.path.join(dir.path, unit + '.yf')
             if not os.path.exists(testfile):
                 print(f"\033[93mWarning: Test {dir.name}/{unit} does not exist\033[0m")
                 continue
-            add_test(testfile, flags, sig['pass'])
+            expect = { key: sig[key] for key in ('run', 'files') if key in sig }
+            add_test(testfile, flags + sig.get('flags', []), sig['pass'], expect, project)
 
     return run_tests()
 
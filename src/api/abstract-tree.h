@@ -4,17 +4,31 @@
  * is in existence should have been fully validated.
  * 
  * This tree structure will look very similar to the CST ... because it is.
+ *
+ * The whole tree lives in one arena, and is freed all at once. Children are
+ * stored in place wherever possible - lists of children are arrays of nodes,
+ * not lists of pointers to nodes.
  */
 
 #ifndef API_ABSTRACT_TREE_H
 #define API_ABSTRACT_TREE_H
 
+#include <stdint.h>
+
 #include <api/operator.h>
 #include <api/sym.h>
-#include <util/list.h>
+#include <util/arena.h>
+#include <util/vec.h>
 
 struct yf_ast_node;
 
+/**
+ * Iterate over an array of children, given as a pointer and a count.
+ * @param out a pointer to the element type, which walks the array
+ */
+#define YFA_FOREACH(array, count, out) \
+    for ((out) = (array); (out) < (array) + (count); ++(out))
+
 /**
  * This represents a single, indivisible value.
  */
@@ -56,7 +70,8 @@ struct yfa_value {
  */
 struct yfa_funccall {
     struct yf_sym * name;
-    struct yf_list args; /* A list of yf_ast_node */
+    struct yf_ast_node * args; /* Each one is an expr */
+    uint32_t num_args;
 };
 
 /**
@@ -66,6 +81,7 @@ struct yfa_funccall {
 struct yfa_expr {
     union {
         struct yfa_value value;
+        /* Both operands are allocated together, right after left. */
         struct yfa_binary {
             struct yfa_expr *left;
             struct yfa_expr *right;
@@ -106,13 +122,13 @@ struct yfa_vardecl {
  * Same deal as vardecl - this only exists to output the appropriate code.
  */
 struct yfa_funcdecl {
-    struct yf_sym * name;
-    struct yfs_type * ret; /* The return type */
+    struct yf_sym * name; /* The return type is name->fn.rtype */
     /* All parameters are stored as vardecls. expr WILL be null for these. */
-    struct yf_list params;
+    struct yf_ast_node * params;
     struct yf_ast_node * body; /* The function body */
     /* The parameter scope */
     struct yfs_symtab * param_scope;
+    uint32_t num_params;
     bool extc; /* Whether the function declaration is extc */
 };
 
@@ -120,12 +136,14 @@ struct yfa_funcdecl {
  * A program is just a list of top-level declarations.
  */
 struct yfa_program {
-    struct yf_list decls;
+    struct yf_ast_node * decls;
+    uint32_t num_decls;
 };
 
 struct yfa_bstmt {
 
-    struct yf_list stmts;
+    struct yf_ast_node * stmts;
+    uint32_t num_stmts;
 
     /* Each block statement has a scope associated with it - or, its own symbol
      * table. Searches for references start here.
@@ -172,6 +190,29 @@ struct yf_ast_node {
 
 };
 
-void yf_cleanup_ast(struct yf_ast_node * node);
+/**
+ * A whole tree, and the memory it's allocated from.
+ */
+struct yf_ast {
+
+    struct yf_ast_node root;
+
+    /* Every node, child array and scope in the tree. */
+    struct yf_arena arena;
+
+    /**
+     * Every scope opened while building the tree - their tables are the only
+     * thing that isn't in the arena, so they're freed without walking the
+     * tree.
+     */
+    struct yf_vec scopes;
+
+};
+
+/**
+ * Free a tree. Safe to call on a zeroed tree, or on one whose validation
+ * failed halfway.
+ */
+void yf_cleanup_ast(struct yf_ast * ast);
 
 #endif /* API_ABSTRACT_TREE_H */
@@ -6,120 +6,17 @@
 #include <api/concrete-tree.h>
 #include <util/allocator.h>
 
-void yf_cleanup_aexpr(struct yfa_expr * node);
-void yf_cleanup_avardecl(struct yfa_vardecl * node);
-void yf_cleanup_afuncdecl(struct yfa_funcdecl * node);
-void yf_cleanup_aprogram(struct yfa_program * node);
-void yf_cleanup_abstmt(struct yfa_bstmt * node);
-void yf_cleanup_areturn(struct yfa_return * node);
-void yf_cleanup_aif(struct yfa_if * node);
-
-void yf_cleanup_anode(struct yf_ast_node * node, int free_node) {
-    switch (node->type) {
-    case YFA_EMPTY:
-        break;
-    case YFA_EXPR:
-        yf_cleanup_aexpr(&node->expr);
-        break;
-    case YFA_VARDECL:
-        yf_cleanup_avardecl(&node->vardecl);
-        break;
-    case YFA_FUNCDECL:
-        yf_cleanup_afuncdecl(&node->funcdecl);
-        break;
-    case YFA_PROGRAM:
-        yf_cleanup_aprogram(&node->program);
-        break;
-    case YFA_BSTMT:
-        yf_cleanup_abstmt(&node->bstmt);
-        break;
-    case YFA_RETURN:
-        yf_cleanup_areturn(&node->ret);
-        break;
-    case YFA_IF:
-        yf_cleanup_aif(&node->ifstmt);
-        break;
-    }
-    if (free_node)
-        yf_free(node);
-}
-
-void yf_cleanup_aexpr(struct yfa_expr * node) {
-    struct yf_ast_node * anode;
-    switch (node->type) {
-    case YFA_E_VALUE:
-        break;
-    case YFA_E_BINARY:
-        yf_cleanup_aexpr(node->as.binary.left);
-        yf_free(node->as.binary.left);
-        yf_cleanup_aexpr(node->as.binary.right);
-        yf_free(node->as.binary.right);
-        break;
-    case YFA_E_FUNCCALL: {
-        YF_LIST_FOREACH(node->as.call.args, anode) {
-            if (anode)
-                yf_cleanup_anode(anode, 1);
-        }
-        yf_list_destroy(&node->as.call.args, 0);
-    }
+void yf_cleanup_ast(struct yf_ast * ast) {
+    struct yfs_symtab * scope;
+    YF_VEC_FOREACH(ast->scopes, scope) {
+        yfh_destroy(
+            &scope->table,
+            /* Sigh ... */
+            (void (*)(void *)) yfs_cleanup_sym
+        );
     }
-}
-
-void yf_cleanup_avardecl(struct yfa_vardecl * node) {
-    if (node->expr)
-        yf_cleanup_anode(node->expr, 1);
-}
-
-void yf_cleanup_afuncdecl(struct yfa_funcdecl * node) {
-    struct yf_ast_node * vardecl;
-    YF_LIST_FOREACH(node->params, vardecl) {
-        yf_cleanup_anode(vardecl, 1);
-    }
-    yf_list_destroy(&node->params, 0);
-    if (node->body)
-        yf_cleanup_anode(node->body, 1);
-    yfh_destroy(&node->param_scope->table, (void (*)(void *)) yfs_cleanup_sym);
-    yf_free(node->param_scope);
-}
-
-void yf_cleanup_aprogram(struct yfa_program * node) {
-    struct yf_ast_node * decl;
-    YF_LIST_FOREACH(node->decls, decl) {
-        if (decl)
-            yf_cleanup_anode(decl, 1);
-    }
-    yf_list_destroy(&node->decls, 0);
-}
-
-void yf_cleanup_abstmt(struct yfa_bstmt * node) {
-    struct yf_ast_node * stmt;
-    YF_LIST_FOREACH(node->stmts, stmt) {
-        if (stmt)
-            yf_cleanup_anode(stmt, 1);
-    }
-    yf_list_destroy(&node->stmts, 0);
-    yfh_destroy(
-        &node->symtab->table,
-        /* Sigh ... */
-        (void (*)(void *)) yfs_cleanup_sym
-    );
-    yf_free(node->symtab);
-}
-
-void yf_cleanup_areturn(struct yfa_return * node) {
-    if (node->expr)
-        yf_cleanup_anode(node->expr, 1);
-}
-
-void yf_cleanup_aif(struct yfa_if * node) {
-    yf_cleanup_anode(node->cond, 1);
-    yf_cleanup_anode(node->code, 1);
-    if (node->elsebranch)
-        yf_cleanup_anode(node->elsebranch, 1);
-}
-
-void yf_cleanup_ast(struct yf_ast_node * node) {
-    yf_cleanup_anode(node, 0);
+    yf_vec_destroy(&ast->scopes, 0);
+    yf_arena_destroy(&ast->arena);
 }
 
 void yf_cleanup_cexpr(struct yfcs_expr * node);
@@ -170,11 +67,11 @@ void yf_cleanup_cexpr(struct yfcs_expr * node) {
         yf_cleanup_cnode(node->binary.right, 1);
         break;
     case YFCS_E_FUNCCALL: {
-        YF_LIST_FOREACH(node->call.args, cnode) {
+        YF_VEC_FOREACH(node->call.args, cnode) {
             if (cnode)
                 yf_cleanup_cnode(cnode, 1);
         }
-        yf_list_destroy(&node->call.args, 0);
+        yf_vec_destroy(&node->call.args, 0);
     }
     }
 }
@@ -186,30 +83,30 @@ void yf_cleanup_cvardecl(struct yfcs_vardecl * node) {
 
 void yf_cleanup_cfuncdecl(struct yfcs_funcdecl * node) {
     struct yf_parse_node * vardecl;
-    YF_LIST_FOREACH(node->params, vardecl) {
+    YF_VEC_FOREACH(node->params, vardecl) {
         yf_cleanup_cnode(vardecl, 1);
     }
-    yf_list_destroy(&node->params, 0);
+    yf_vec_destroy(&node->params, 0);
     if (node->body)
         yf_cleanup_cnode(node->body, 1);
 }
 
 void yf_cleanup_cprogram(struct yfcs_program * node) {
     struct yf_parse_node * decl;
-    YF_LIST_FOREACH(node->decls, decl) {
+    YF_VEC_FOREACH(node->decls, decl) {
         if (decl)
             yf_cleanup_cnode(decl, 1);
     }
-    yf_list_destroy(&node->decls, 0);
+    yf_vec_destroy(&node->decls, 0);
 }
 
 void yf_cleanup_cbstmt(struct yfcs_bstmt * node) {
     struct yf_parse_node * stmt;
-    YF_LIST_FOREACH(node->stmts, stmt) {
+    YF_VEC_FOREACH(node->stmts, stmt) {
         if (stmt)
             yf_cleanup_cnode(stmt, 1);
     }
-    yf_list_destroy(&node->stmts, 0);
+    yf_vec_destroy(&node->stmts, 0);
 }
 
 void yf_cleanup_creturn(struct yfcs_return * node) {
@@ -237,7 +134,7 @@ void yfs_cleanup_sym(struct yf_sym * sym) {
     case YFS_VAR:
         break;
     case YFS_FN:
-        yf_list_destroy(&sym->fn.params, 1);
+        yf_vec_destroy(&sym->fn.params, 1);
         break;
     }
     yf_free(sym);
@@ -14,10 +14,17 @@
 #include <api/sym.h>
 #include <util/list.h>
 #include <util/hashmap.h>
+#include <util/profile.h>
+#include <util/strbuf.h>
+#include <util/vec.h>
+
+struct yf_build_db;
 
 enum yf_compilation_job_type {
     YF_COMPILATION_ANALYSE,
+    YF_COMPILATION_INDEX,
     YF_COMPILATION_COMPILE,
+    YF_COMPILATION_UNITY,
     YF_COMPILATION_EXEC,
 };
 
@@ -31,6 +38,22 @@ enum yf_compilation_stage {
 
 struct yf_compilation_job {
     enum yf_compilation_job_type type;
+
+    /** When the job ran, on the profiler's clock - zero if it never did */
+    uint64_t start_ns, end_ns;
+
+    /** Which track the job ran on: 0 is the compiler itself, and the others
+    are slots for child processes */
+    int track;
+
+    /**
+     * The jobs that can't start until this one is done
+     * @item_type yf_compilation_job
+     */
+    struct yf_vec dependents;
+
+    /** How many jobs this one is still waiting for */
+    unsigned waiting_for;
 };
 
 /** Represents various info about a compilation unit */
@@ -69,23 +92,122 @@ struct yf_compile_analyse_job {
 
     struct yfs_type_table types;
 
-    struct yf_ast_node ast_tree;
+    struct yf_ast ast_tree;
+
+    /**
+     * Owns all names used by the symbol tables and the AST, so that they don't
+     * depend on the parse tree - which is freed right after validation.
+     */
+    struct yf_intern_table strings;
+
+    struct yfs_lookup_stats lookups;
 
+    struct yf_profile_unit profile;
+
+    /** What the source and its global symbols hashed to, when analysed -
+    only with a build database */
+    uint64_t source_hash, interface_hash;
+
+    /** Whether nothing in the unit can be reached from the entry point - set
+    by the index job. Its object isn't compiled or linked. */
+    bool dead;
+
+    /** The globals of other units that this one uses, each once - found by
+    the index job, so that the unit's code can declare them */
+    struct yf_vec imports;
+
+};
+
+/** Index the symbols of all analysed units, once all of them are analysed */
+struct yf_compile_index_job {
+    struct yf_compilation_job job;
+
+    /** Whether exactly one "main" function is required */
+    bool need_entry_point;
 };
 
+struct yf_compile_unity_job;
+
 /** Compile output file and a symbol file from a compilation unit */
 struct yf_compile_compile_job {
     struct yf_compilation_job job;
 
     struct yf_compile_analyse_job * unit;
 
+    /** With --unity, the job that generates this unit's code along with
+    others' - this job only validates it. NULL otherwise. */
+    struct yf_compile_unity_job * shard;
+
+    /** With --no-c-files, the C code is kept here for the C compiler, instead
+    of being written to a file */
+    bool in_memory;
+    struct yf_strbuf code;
+
+};
+
+/** With --unity, generate the code of several units as one C file */
+struct yf_compile_unity_job {
+    struct yf_compilation_job job;
+
+    /**
+     * The units in this file, validated by these jobs
+     * @item_type yf_compile_compile_job
+     */
+    struct yf_vec units;
+
+    /** Where the C code is written */
+    char * output_file;
+
+    /** Like for a compile job, with --no-c-files */
+    bool in_memory;
+    struct yf_strbuf code;
+
+    /** Whether the C file is already current, once that has been checked -
+    and what it's made from */
+    bool checked, current;
+    uint64_t inputs;
 };
 
 struct yf_compile_exec_job {
     struct yf_compilation_job job;
 
+    /** YF_PHASE_CC or YF_PHASE_LINK, for profiling */
+    enum yf_profile_phase phase;
+
+    /** The unit being compiled, or NULL when linking */
+    struct yf_compile_analyse_job * unit;
+
+    /** How the command went, once it has run */
+    int exit_code;
+    long user_us, sys_us, maxrss_kb;
+
     /** Null-terminated array of arguments (argument are not owned, array is) */
     const char ** command;
+
+    /** What to write to the command's standard input, or NULL - this is freed
+    once it has been written */
+    struct yf_strbuf * stdin_data;
+
+    /** While the command runs and stdin_data is set: the pipe to its standard
+    input, or -1 if writing to it failed, and how much has been written */
+    int stdin_fd;
+    size_t stdin_written;
+
+    /** The file the command writes, and the files it reads - to tell whether
+    it needs to run at all. Both point into the command. */
+    const char * output;
+    const char ** inputs;
+    size_t num_inputs;
+
+    /** Whether the output was up to date, so the command wasn't run */
+    bool cached;
+
+    /** Whether the output isn't needed after all, so the command isn't run -
+    set before any command is started */
+    bool skip;
+
+    /** All inputs hashed together, when checked against the build database */
+    uint64_t inputs_hash;
 };
 
 /*
@@ -103,10 +225,28 @@ struct yf_compilation_data {
     char * project_name;
 
     /**
-     * Will contain pointers to translation_units' symbol tables as they are analysed
-     * @item_type yfs_symtab
+     * All global symbols of all analysed units - built by the index job, and
+     * read-only after that.
      */
-    struct yf_hashmap symtables;
+    struct yfs_symbol_index symindex;
+
+    /** What the last build made, to skip work that's already done - NULL
+    outside of a project, unless the C compiler runs */
+    struct yf_build_db * build_db;
+
+    /** The interfaces of all units together - set by the index job */
+    uint64_t interfaces_hash;
+
+    /** Generate code that counts the calls and time of every function */
+    bool instrument;
+
+    /** With --pgo-generate or --pgo-use, the flag that points the C compiler
+    at the profile, like -fprofile-dir=/abs/bin/pgo - NULL otherwise */
+    char * pgo_dir_flag;
+
+    /** With --pgo-use, what the profile file of each object starts with:
+    the directory, then the working directory with '/' turned into '#' */
+    char * pgo_prefix;
 
     /**
      * Holds additional references that will be cleaned
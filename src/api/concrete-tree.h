@@ -23,7 +23,7 @@
 
 #include <api/loc.h>
 #include <api/operator.h>
-#include <util/list.h>
+#include <util/vec.h>
 
 struct yf_parse_node;
 
@@ -69,7 +69,7 @@ struct yfcs_type {
  */
 struct yfcs_funccall {
     struct yfcs_identifier name;
-    struct yf_list args; /* A list of yf_parse_node */
+    struct yf_vec args; /* A vector of yf_parse_node */
 };
 
 struct yfcs_expr {
@@ -110,7 +110,7 @@ struct yfcs_funcdecl {
     struct yfcs_identifier name;
     struct yfcs_type ret; /* The return type */
     /* All parameters are stored as parse_node. expr WILL be null for these. */
-    struct yf_list params;
+    struct yf_vec params;
     struct yf_parse_node * body; /* The function body */
     bool extc; /* Whether the function is an extc one */
 };
@@ -122,14 +122,14 @@ struct yfcs_if {
 };
 
 struct yfcs_program {
-    struct yf_list decls;
+    struct yf_vec decls;
 };
 
 /**
  * A block statement.
  */
 struct yfcs_bstmt {
-    struct yf_list stmts;
+    struct yf_vec stmts;
 };
 
 struct yf_parse_node {
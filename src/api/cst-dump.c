@@ -89,7 +89,7 @@ static void yf_dump_program(struct yfcs_program * node, FILE *out) {
 
     yf_print_line(out, "program");
     indent();
-    YF_LIST_FOREACH(node->decls, child) {
+    YF_VEC_FOREACH(node->decls, child) {
         yf_dump_cst(child, out);
     }
     dedent();
@@ -126,7 +126,7 @@ static void yf_dump_funcdecl(struct yfcs_funcdecl * node, FILE * out) {
     yf_print_line(out, "params");
     indent();
     struct yf_parse_node * param;
-    YF_LIST_FOREACH(node->params, param) {
+    YF_VEC_FOREACH(node->params, param) {
         yf_dump_cst(param, out);
     }
     dedent();
@@ -179,7 +179,7 @@ static void yf_dump_expr(struct yfcs_expr * node, FILE * out) {
         );
         yf_print_line(out, "arguments:");
         indent();
-        YF_LIST_FOREACH(node->call.args, arg) {
+        YF_VEC_FOREACH(node->call.args, arg) {
             yf_dump_cst(arg, out);
         }
         dedent();
@@ -196,7 +196,7 @@ static void yf_dump_bstmt(struct yfcs_bstmt * node, FILE * out) {
     struct yf_parse_node * child;
     yf_print_line(out, "block statement");
     indent();
-    YF_LIST_FOREACH(node->stmts, child) {
+    YF_VEC_FOREACH(node->stmts, child) {
         yf_dump_cst(child, out);
     }
     dedent();
@@ -5,12 +5,19 @@
 #ifndef API_GENERATION_H
 #define API_GENERATION_H
 
+#include <stdbool.h>
+
 struct yf_gen_info {
 
     char * yf_prefix; /* The prefix in Y-flat, like path.to.foo */
     char gen_prefix[256]; /* The prefix in generated code, like path$to$foo */
     int tab_depth; /* For the indentation level and proper formatting. */
 
+    /* With --instrument, count the calls and time of every function. The
+    functions of a unit are numbered in order, as they're generated. */
+    bool instrument;
+    int num_instrumented;
+
 };
 
 #endif /* API_GENERATION_H */
@@ -9,9 +9,13 @@
 #ifndef API_SYM_H
 #define API_SYM_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <api/loc.h>
-#include <util/list.h>
+#include <util/vec.h>
 #include <util/hashmap.h>
+#include <util/intern.h>
 
 /**
  * What 'kind' of number does a primitive type represent?
@@ -27,8 +31,63 @@ struct yfs_primitive_type {
     enum yfpt_format type;
 };
 
+/**
+ * Every builtin type, as X(ID, name, size in bits, format, ctx). This list is
+ * the only place builtin types are defined - the type table, the handles, the
+ * builtin IDs and the conversion table are all generated from it. ctx is passed
+ * to X unchanged, so that the list can be expanded again from inside X.
+ * All types are signed for now - unsigned types are not yet supported.
+ * We're considering bool to be one bit for conversion purposes.
+ */
+#define YFS_BUILTIN_TYPES(X, ctx) \
+    /* "standard" types. */ \
+    X(CHAR,   char,     8, YFS_F_INT,   ctx) \
+    X(SHORT,  short,   16, YFS_F_INT,   ctx) \
+    X(INT,    int,     32, YFS_F_INT,   ctx) \
+    X(LONG,   long,    64, YFS_F_INT,   ctx) \
+    X(VOID,   void,     0, YFS_F_NONE,  ctx) \
+    X(FLOAT,  float,   32, YFS_F_FLOAT, ctx) \
+    X(DOUBLE, double,  64, YFS_F_FLOAT, ctx) \
+    /* Convenience types. */ \
+    X(I16,    i16,     16, YFS_F_INT,   ctx) \
+    X(I32,    i32,     32, YFS_F_INT,   ctx) \
+    X(I64,    i64,     64, YFS_F_INT,   ctx) \
+    X(F16,    f16,     16, YFS_F_FLOAT, ctx) \
+    X(F32,    f32,     32, YFS_F_FLOAT, ctx) \
+    X(F64,    f64,     64, YFS_F_FLOAT, ctx) \
+    X(BOOL,   bool,     1, YFS_F_INT,   ctx)
+
+/**
+ * How a primitive type is spelled in C, given its size in bits and format, or
+ * NULL if C has no such type. This is a constant expression, so the builtin
+ * types can be spelled statically. Generated code always includes stdint.h.
+ */
+#define YFS_C_SPELLING(size, fmt) ( \
+    (size) == 0           ? "void"    : \
+    (fmt) == YFS_F_FLOAT  ? ( \
+        (size) == 16 || (size) == 32 ? "float"  : \
+        (size) == 64                 ? "double" : NULL) : \
+    (size) == 1           ? "_Bool"   : \
+    (size) == 8           ? "int8_t"  : \
+    (size) == 16          ? "int16_t" : \
+    (size) == 32          ? "int32_t" : \
+    (size) == 64          ? "int64_t" : NULL \
+)
+
+/**
+ * Dense IDs for the builtin types. YFS_B_NONE is for user-defined types.
+ */
+enum yfs_builtin_id {
+    YFS_B_NONE,
+#define YFS_BUILTIN_ID(id, name, size, fmt, ctx) YFS_B_ ## id,
+    YFS_BUILTIN_TYPES(YFS_BUILTIN_ID, )
+#undef YFS_BUILTIN_ID
+    YFS_B_COUNT
+};
+
 /* Has names even though types are stored in a hashmap, in case errors are to be
-reported. NO nesting needed - all types are globally visible. */
+reported. NO nesting needed - all types are globally visible.
+Builtin types are shared between all units and must never be modified. */
 struct yfs_type {
 
     union {
@@ -39,7 +98,13 @@ struct yfs_type {
         YFS_T_PRIMITIVE,
     } kind;
 
-    char * name; /* Name of the type */
+    const char * name; /* Name of the type */
+
+    enum yfs_builtin_id builtin;
+
+    /* How the type is spelled in C, or NULL if it can't be. Set when the
+    type is made - builtins are spelled statically. */
+    const char * cname;
 
 };
 
@@ -50,8 +115,8 @@ void yfs_cleanup_type(struct yfs_type * type);
 
 struct yfs_var {
 
-    char * name;
-    struct yfs_type * dtype; /* "declared type" */    
+    const char * name; /* Interned by the unit */
+    const struct yfs_type * dtype; /* "declared type" */
 
 };
 
@@ -61,14 +126,17 @@ struct yfs_var {
  * the types that exist are not yet known.
  */
 struct yfsn_param {
-    char * name, * type;
+    const char * name, * type; /* Interned by the unit */
+    /* The resolved type, if it was already known when the symbol table was
+    built (builtin types are). NULL otherwise. */
+    const struct yfs_type * dtype;
 };
 
 struct yfs_fn {
 
-    char * name;
-    struct yfs_type * rtype; /* "return type" */
-    struct yf_list    params; /* list of param */
+    const char * name; /* Interned by the unit */
+    const struct yfs_type * rtype; /* "return type" */
+    struct yf_vec     params; /* vector of param */
 
 };
 
@@ -86,6 +154,19 @@ struct yf_sym {
 
     struct yf_location loc;
 
+    /* The identifier prefix of the unit that declares a global symbol, like
+    path.to.foo - or NULL, for locals and outside of a project. Owned by the
+    unit. */
+    const char * prefix;
+
+    /* Whether another unit refers to this global - set by the symbol index.
+    Functions no other unit uses get internal linkage in C. */
+    bool exported;
+
+    /* Whether the global can be reached from the entry point - set when a
+    program is linked. No code is generated for the ones that can't. */
+    bool reachable;
+
 };
 
 void yfs_cleanup_sym(struct yf_sym * sym);
@@ -98,12 +179,66 @@ struct yfs_symtab {
      * file symtab, and for file symtabs this is NULL. */
     struct yfs_symtab * parent;
 
+    /* A one-word Bloom filter of the names in table, so that lookups can skip
+     * scopes that can't contain a name. Kept up to date by yfs_symtab_add. */
+    uint64_t filter;
+
+};
+
+/**
+ * How scope lookups went in a unit, for --profile.
+ */
+struct yfs_lookup_stats {
+    unsigned long probes; /* Scope hashmaps actually searched */
+    unsigned long skipped; /* Scopes ruled out by their filter */
 };
 
+/**
+ * User-defined types of a unit. Builtin types are not stored here - the table
+ * is only initialized once the first type is added.
+ */
 struct yfs_type_table {
 
     struct yf_hashmap table;
 
 };
 
+/**
+ * Every global symbol of a project, keyed by (module ID, name). This is built
+ * once all units have been analysed and is never modified after that, so any
+ * number of validators may read it at once without locking.
+ */
+struct yfs_symbol_index {
+
+    /* All analysed units. A module's ID is its index here. */
+    struct yfs_index_module {
+        const char * prefix; /* Like path.to.foo - NULL outside a project. */
+        struct yfs_symtab * symtab;
+    } * modules;
+    unsigned num_modules;
+
+    /* Prefix -> struct yfs_index_module */
+    struct yf_hashmap module_map;
+
+    /* Open addressing, the size is a power of two. Empty slots have no sym. */
+    struct yfs_index_entry {
+        unsigned long hash;
+        unsigned module;
+        const char * name; /* Interned */
+        struct yf_sym * sym;
+    } * entries;
+    unsigned long num_entries;
+
+    struct yf_intern_table names;
+
+    /* The "main" function, if there is exactly one. */
+    struct yf_sym * entry_point;
+    unsigned num_entry_points;
+
+    /* A hash of which globals are exported and which are reachable, so that
+    code generated from the index can be told apart. */
+    uint64_t usage_hash;
+
+};
+
 #endif /* API_SYM_H */
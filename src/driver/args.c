@@ -4,6 +4,7 @@
 
 #include "args.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +35,53 @@ static void yf_check_action(struct yf_args * args, enum yf_info_output out) {
     }
 }
 
+/**
+ * Internal - check for an option that takes a value, given either as
+ * "name=value" or as the next argument. Returns whether arg is the option;
+ * if it is, the value is stored, or NULL if it's missing.
+ */
+static bool yf_get_option(
+    const char * arg, const char * name,
+    int argc, char ** argv, int * i,
+    const char ** value
+) {
+
+    size_t len = strlen(name);
+
+    if (strncmp(arg, name, len) != 0)
+        return false;
+
+    if (arg[len] == '=') {
+        *value = arg + len + 1;
+    } else if (arg[len] == '\0') {
+        *value = (*i + 1 < argc) ? argv[++*i] : NULL;
+    } else {
+        return false;
+    }
+
+    return true;
+
+}
+
+/**
+ * Internal - parse a positive number. Returns 0 if it isn't one.
+ */
+static int yf_parse_count(const char * str) {
+
+    char * end;
+    long count;
+
+    if (!str || !*str)
+        return 0;
+
+    count = strtol(str, &end, 10);
+    if (*end || count <= 0 || count > 1024)
+        return 0;
+
+    return (int) count;
+
+}
+
 /**
  * Internal - add a file. Return 1 if too many files.
  */
@@ -56,6 +104,7 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
     
     int i;
     char * arg;
+    const char * value;
     
     /* If the next option we're parsing is the native C compiler name */
     bool want_compiler_name = false;
@@ -123,6 +172,18 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
             if (arg[0] == '-')
                 ++arg;
 
+            /* -j N, -jN or --jobs N */
+            if (yf_get_option(arg, "j", argc, argv, &i, &value)
+                || yf_get_option(arg, "jobs", argc, argv, &i, &value)
+                || (arg[0] == 'j' && isdigit((unsigned char) arg[1])
+                    && (value = arg + 1))) {
+                if (args->jobs || !(args->jobs = yf_parse_count(value))) {
+                    yf_set_error(args);
+                    return;
+                }
+                continue;
+            }
+
             if (STREQ(arg, "help")) {
                 yf_check_action(args, YF_HELP);
                 continue;
@@ -163,10 +224,83 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
             }
 
             if (STREQ(arg, "just-gen")) {
+                if (args->no_c_files) {
+                    yf_set_error(args);
+                    return;
+                }
                 args->run_c_comp = false;
                 continue;
             }
 
+            /* --unity or --unity=N, but not --unity N - that's a file. */
+            if (STREQ(arg, "unity") || !strncmp(arg, "unity=", 6)) {
+                if (args->unity || !(args->unity =
+                    arg[5] ? yf_parse_count(arg + 6) : 1)) {
+                    yf_set_error(args);
+                    return;
+                }
+                continue;
+            }
+
+            /* Without the C compiler, there'd be nothing to pipe into. */
+            if (STREQ(arg, "no-c-files")) {
+                if (!args->run_c_comp) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->no_c_files = true;
+                continue;
+            }
+
+            /* -O0 to -O3 and -Os go straight to the C compiler. The dash
+            before arg is kept, even if it was given as --O2. */
+            if (arg[0] == 'O' && arg[1] && strchr("0123s", arg[1])
+                && !arg[2]) {
+                args->opt_level = arg - 1;
+                continue;
+            }
+
+            if (STREQ(arg, "lto")) {
+                args->lto = true;
+                continue;
+            }
+
+            if (yf_get_option(arg, "cflags", argc, argv, &i, &value)) {
+                if (!value || args->cflags) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->cflags = value;
+                continue;
+            }
+
+            if (yf_get_option(arg, "ldflags", argc, argv, &i, &value)) {
+                if (!value || args->ldflags) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->ldflags = value;
+                continue;
+            }
+
+            /* --pgo-generate[=<dir>] and --pgo-use[=<dir>] */
+            if (!strncmp(arg, "pgo-generate", 12)
+                || !strncmp(arg, "pgo-use", 7)) {
+                value = arg + (arg[4] == 'g' ? 12 : 7);
+                if (args->pgo || (*value && (*value != '=' || !value[1]))) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->pgo = arg[4] == 'g' ? YF_PGO_GENERATE : YF_PGO_USE;
+                args->pgo_dir = *value ? value + 1 : NULL;
+                continue;
+            }
+
+            if (STREQ(arg, "instrument")) {
+                args->instrument = true;
+                continue;
+            }
+
             if (STREQ(arg, "dump-tokens")) {
                 if (args->cstdump || args->just_semantics) {
                     yf_set_error(args);
@@ -194,7 +328,8 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
                 continue;
             }
 
-            if (STREQ(arg, "benchmark")) {
+            /* --benchmark is the old name. */
+            if (STREQ(arg, "profile") || STREQ(arg, "benchmark")) {
                 if (args->profile || args->wanted_output != YF_NONE) {
                     yf_set_error(args);
                     return;
@@ -203,6 +338,15 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
                 continue;
             }
 
+            if (STREQ(arg, "mem-report")) {
+                if (args->mem_report || args->wanted_output != YF_NONE) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->mem_report = 1;
+                continue;
+            }
+
             if (STREQ(arg, "dump-projfiles")) {
                 args->dump_projfiles = 1;
                 args->project = 1;
@@ -220,6 +364,15 @@ void yf_parse_args(int argc, char ** argv, struct yf_args * args) {
                 continue;
             }
 
+            if (yf_get_option(arg, "trace-out", argc, argv, &i, &value)) {
+                if (!value || !*value || args->trace_out) {
+                    yf_set_error(args);
+                    return;
+                }
+                args->trace_out = value;
+                continue;
+            }
+
             /* No other options are known. Yet. */
             yf_set_error(args);
             return;
@@ -20,6 +20,15 @@ enum yf_info_output {
     YF_ERROR_NO_ARGS, /* SPECIFICALLY if no arguments are given. */
 };
 
+/**
+ * Building for profile-guided optimization?
+ */
+enum yf_pgo_mode {
+    YF_PGO_NONE,
+    YF_PGO_GENERATE, // Build a program that collects a profile when run
+    YF_PGO_USE, // Optimize with the profile collected
+};
+
 enum yf_compiler_class {
     YF_COMPILER_UNKNOWN,
     YF_COMPILER_GCC, // A gcc-like compiler
@@ -84,6 +93,47 @@ struct yf_args {
      */
     bool run_c_comp;
 
+    /**
+     * Pipe the generated code straight into the C compiler, without writing
+     * any C files?
+     */
+    bool no_c_files;
+
+    /**
+     * How many C files to generate for the whole program, or 0 for one per
+     * unit.
+     */
+    int unity;
+
+    /**
+     * The C compiler's optimization flag, like "-O2", or NULL to leave it to
+     * the compiler.
+     */
+    const char * opt_level;
+
+    /**
+     * Optimize across units at link time?
+     */
+    bool lto;
+
+    /**
+     * Extra flags for the C compiler and for the linker, separated by spaces,
+     * or NULL for none.
+     */
+    const char * cflags, * ldflags;
+
+    /**
+     * Profile-guided optimization, and where the profile is kept - or NULL
+     * for the default, which is bin/pgo in a project.
+     */
+    enum yf_pgo_mode pgo;
+    const char * pgo_dir;
+
+    /**
+     * Make the program count the calls and time of each function?
+     */
+    bool instrument;
+
     /**
      * Should we be profiling how long it takes?
      */
@@ -104,6 +154,21 @@ struct yf_args {
      */
     bool simulate_run;
 
+    /**
+     * Where to write a trace of all jobs, or NULL for no trace.
+     */
+    const char * trace_out;
+
+    /**
+     * Print how much memory each part of the compiler allocated.
+     */
+    bool mem_report;
+
+    /**
+     * How many commands may run at once, or 0 for one per processor.
+     */
+    int jobs;
+
 };
 
 /**
@@ -0,0 +1,244 @@
+#include "builddb.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <driver/os.h>
+#include <util/allocator.h>
+#include <util/hash.h>
+
+/* The first line of every database - bump the version when the format
+changes, so that old databases are ignored. */
+#define YF_BUILD_DB_HEADER "yfc-build-db 1\n"
+
+/* Files modified this close to when the database is saved (in seconds) might
+still change within the same tick of the file system clock - without their
+size or modification time changing - so they are always hashed again. */
+#define YF_BUILD_DB_RACY_WINDOW 2
+
+/* The longest file name a database line can hold. */
+#define YF_BUILD_DB_MAX_PATH 1024
+
+int yf_build_db_load(struct yf_build_db * db, const char * path) {
+
+    FILE * file;
+    char line[YF_BUILD_DB_MAX_PATH + 128];
+    char name[YF_BUILD_DB_MAX_PATH];
+    struct yf_build_record rec, * copy;
+
+    db->path = yf_strdup(path);
+    yfh_init(&db->records);
+    if (!db->path || !db->records.buckets)
+        return 3;
+
+    file = fopen(path, "r");
+    if (!file)
+        return 0;
+
+    if (!fgets(line, sizeof line, file) || strcmp(line, YF_BUILD_DB_HEADER)) {
+        fclose(file);
+        return 0;
+    }
+
+    /* hash size mtime interface inputs command name */
+    while (fgets(line, sizeof line, file)) {
+        if (sscanf(line,
+            "%" SCNx64 " %" SCNd64 " %" SCNd64 " %" SCNx64 " %" SCNx64
+            " %" SCNx64 " %1023[^\n]",
+            &rec.hash, &rec.size, &rec.mtime, &rec.interface, &rec.inputs,
+            &rec.command, name
+        ) != 7)
+            continue;
+        if (!(copy = yf_build_db_record(db, name))) {
+            fclose(file);
+            return 3;
+        }
+        *copy = rec;
+    }
+
+    fclose(file);
+    return 0;
+
+}
+
+int yf_build_db_save(struct yf_build_db * db) {
+
+    FILE * file;
+    char * tmp_path;
+    struct yfh_cursor cursor;
+    const char * name;
+    struct yf_build_record * rec;
+    size_t len = strlen(db->path);
+    int64_t racy;
+    int failed;
+
+    /* Written next to the database and renamed over it, so that a build
+    that's interrupted never leaves half a database behind. */
+    if (!(tmp_path = yf_malloc(len + sizeof ".tmp")))
+        return 1;
+    memcpy(tmp_path, db->path, len);
+    memcpy(tmp_path + len, ".tmp", sizeof ".tmp");
+
+    if (!(file = fopen(tmp_path, "w"))) {
+        yf_free(tmp_path);
+        return 1;
+    }
+
+    racy = ((int64_t) time(NULL) - YF_BUILD_DB_RACY_WINDOW) * 1000000000LL;
+
+    fputs(YF_BUILD_DB_HEADER, file);
+    for (yfh_cursor_init(&cursor, &db->records); !yfh_cursor_next(&cursor); ) {
+        yfh_cursor_get(&cursor, &name, (void **) &rec);
+        fprintf(file,
+            "%016" PRIx64 " %" PRId64 " %" PRId64 " %016" PRIx64 " %016" PRIx64
+            " %016" PRIx64 " %s\n",
+            rec->hash, rec->size, rec->mtime >= racy ? 0 : rec->mtime,
+            rec->interface, rec->inputs, rec->command, name
+        );
+    }
+
+    failed = fclose(file) != 0;
+    failed = failed || file_replace(tmp_path, db->path);
+    if (failed)
+        remove(tmp_path);
+    yf_free(tmp_path);
+
+    return failed;
+
+}
+
+void yf_build_db_destroy(struct yf_build_db * db) {
+    yfh_destroy(&db->records, yf_free);
+    yf_free(db->path);
+}
+
+struct yf_build_record * yf_build_db_record(
+    struct yf_build_db * db, const char * path
+) {
+
+    struct yf_build_record * rec;
+
+    if (yfh_get(&db->records, path, (void **) &rec) == 0)
+        return rec;
+
+    if (strlen(path) >= YF_BUILD_DB_MAX_PATH)
+        return NULL;
+    if (!(rec = yf_calloc(1, sizeof *rec)))
+        return NULL;
+    if (yfh_set(&db->records, path, rec)) {
+        yf_free(rec);
+        return NULL;
+    }
+
+    return rec;
+
+}
+
+/**
+ * Internal - read a whole file and hash it.
+ */
+static int yf_hash_file(const char * path, int64_t size, uint64_t * hash) {
+
+    FILE * file;
+    char * buf;
+    size_t read;
+
+    if (!(file = fopen(path, "rb")))
+        return 1;
+
+    if (!(buf = yf_malloc(size ? size : 1))) {
+        fclose(file);
+        return 1;
+    }
+
+    read = fread(buf, 1, size, file);
+    fclose(file);
+
+    if (read != (size_t) size) {
+        yf_free(buf);
+        return 1;
+    }
+
+    *hash = yf_hash(buf, size, 0);
+    yf_free(buf);
+    return 0;
+
+}
+
+int yf_build_db_file_hash(
+    struct yf_build_db * db, const char * path, uint64_t * hash
+) {
+
+    struct yf_build_record * rec;
+    int64_t size, mtime;
+
+    if (file_info(path, &size, &mtime))
+        return 1;
+
+    if (!db)
+        return yf_hash_file(path, size, hash);
+
+    if (!(rec = yf_build_db_record(db, path)))
+        return 1;
+
+    if (rec->size != size || rec->mtime != mtime || rec->mtime == 0) {
+        if (yf_hash_file(path, size, &rec->hash))
+            return 1;
+        rec->size = size;
+        rec->mtime = mtime;
+    }
+
+    *hash = rec->hash;
+    return 0;
+
+}
+
+bool yf_build_db_is_current(
+    struct yf_build_db * db, const char * path, uint64_t inputs, uint64_t command
+) {
+
+    struct yf_build_record * rec;
+    uint64_t made_hash, hash;
+
+    if (yfh_get(&db->records, path, (void **) &rec) || !rec->inputs)
+        return false;
+
+    if (rec->inputs != inputs || rec->command != command)
+        return false;
+
+    /* The file itself must still be what we made. */
+    made_hash = rec->hash;
+    if (yf_build_db_file_hash(db, path, &hash))
+        return false;
+
+    return hash == made_hash;
+
+}
+
+void yf_build_db_forget(struct yf_build_db * db, const char * path) {
+
+    struct yf_build_record * rec;
+
+    if (yfh_get(&db->records, path, (void **) &rec) == 0)
+        rec->inputs = rec->command = 0;
+
+}
+
+int yf_build_db_made(
+    struct yf_build_db * db, const char * path, uint64_t inputs, uint64_t command
+) {
+
+    struct yf_build_record * rec;
+    uint64_t hash;
+
+    if (yf_build_db_file_hash(db, path, &hash))
+        return 1;
+
+    rec = yf_build_db_record(db, path);
+    rec->inputs = inputs;
+    rec->command = command;
+    return 0;
+
+}
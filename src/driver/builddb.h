@@ -0,0 +1,102 @@
+/**
+ * The build database, which remembers what every file of the last build looked
+ * like, and what every generated file was made from. It's what lets a build
+ * skip work whose inputs haven't changed - judged by their contents, not by
+ * their modification times, so touching a file or switching branches back and
+ * forth doesn't cause a rebuild.
+ *
+ * A file's contents are only hashed when its size or modification time differ
+ * from the last time it was hashed; otherwise, the stored hash is used. Files
+ * modified just before the database was saved are always hashed again, since
+ * they could have changed again within the same tick of the file system clock.
+ */
+
+#ifndef DRIVER_BUILDDB_H
+#define DRIVER_BUILDDB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <util/hashmap.h>
+
+/**
+ * What we know about a single file.
+ */
+struct yf_build_record {
+
+    /* When the file was hashed, and what its contents hashed to. */
+    int64_t size, mtime;
+    uint64_t hash;
+
+    /* Only for source files - a hash of the unit's global symbols. */
+    uint64_t interface;
+
+    /* Only for generated files - a hash of all inputs it was made from, and
+    of the command that made it. Zero if it wasn't made successfully. */
+    uint64_t inputs, command;
+
+};
+
+struct yf_build_db {
+
+    /* Where the database is stored. */
+    char * path;
+
+    /* File name -> struct yf_build_record */
+    struct yf_hashmap records;
+
+};
+
+/**
+ * Load the database from a file. A missing or unreadable database is just
+ * empty - everything will be rebuilt. Returns 3 if we run out of memory.
+ */
+int yf_build_db_load(struct yf_build_db *, const char * path);
+
+/**
+ * Write the database back to where it was loaded from. Returns 1 if it
+ * couldn't be written.
+ */
+int yf_build_db_save(struct yf_build_db *);
+
+void yf_build_db_destroy(struct yf_build_db *);
+
+/**
+ * Get the record of a file, adding an empty one if there is none. Returns NULL
+ * if we run out of memory.
+ */
+struct yf_build_record * yf_build_db_record(
+    struct yf_build_db *, const char * path
+);
+
+/**
+ * Get the hash of a file's contents. Returns 1 if the file can't be read.
+ * Without a database (NULL), the file is always read.
+ */
+int yf_build_db_file_hash(
+    struct yf_build_db *, const char * path, uint64_t * hash
+);
+
+/**
+ * Check whether a generated file is current: it exists, hasn't changed since
+ * it was made, and was made from the same inputs by the same command.
+ */
+bool yf_build_db_is_current(
+    struct yf_build_db *, const char * path, uint64_t inputs, uint64_t command
+);
+
+/**
+ * Forget how a file was made, right before making it again. Should that fail,
+ * the file won't look current next time.
+ */
+void yf_build_db_forget(struct yf_build_db *, const char * path);
+
+/**
+ * Record that a file was just made from the given inputs by the given command.
+ * Returns 1 if it can't be read back.
+ */
+int yf_build_db_made(
+    struct yf_build_db *, const char * path, uint64_t inputs, uint64_t command
+);
+
+#endif /* DRIVER_BUILDDB_H */
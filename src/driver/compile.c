@@ -4,20 +4,29 @@
 #include <stdlib.h> /* malloc */
 #include <string.h> /* strcpy */
 #include <sys/stat.h>
-#include <sys/time.h> /* struct timeval */
 #include <unistd.h> /* getcwd */
 
 #include <api/compilation-data.h>
 #include <api/cst-dump.h>
 #include <api/lexer-input.h>
+#include <driver/builddb.h>
 #include <driver/compiler-backend.h>
 #include <driver/find-files.h>
+#include <driver/os.h>
+#include <driver/scheduler.h>
+#include <driver/trace.h>
+#include <gen/gen.h>
 #include <parser/parser.h>
+#include <semantics/fold.h>
+#include <semantics/symindex.h>
 #include <semantics/symtab.h>
 #include <semantics/validate/validate.h>
 #include <util/allocator.h>
+#include <util/hash.h>
 #include <util/list.h>
 #include <util/hashmap.h>
+#include <util/profile.h>
+#include <util/vec.h>
 #include <util/yfc-out.h>
 
 /* Forward decls for whole file */
@@ -27,20 +36,44 @@ static int yfc_run_frontend_build_symtable(
     struct yf_compilation_data *,
     struct yf_compile_analyse_job *
 );
+static int yfc_build_symbol_index(
+    struct yf_compilation_data *,
+    struct yf_compile_index_job *
+);
 static int yfc_validate_compile(
     struct yf_compilation_data *,
     struct yf_compile_compile_job *
 );
+static bool yf_unity_current(
+    struct yf_compilation_data *,
+    struct yf_compile_unity_job *
+);
+static int yfc_generate_unity(
+    struct yf_compilation_data *,
+    struct yf_compile_unity_job *
+);
+static uint64_t yf_codegen_version(struct yf_compilation_data *);
 static int yf_find_project_files(struct yf_project_compilation_data *);
 static int dump_tokens(struct yf_lexer *);
 static int yf_build_symtab(struct yf_compile_analyse_job *);
+static int yf_record_unit(
+    struct yf_build_db *, struct yf_compile_analyse_job *
+);
 static int yf_validate_ast(
     struct yf_compilation_data * pdata,
     struct yf_compile_analyse_job * adata
 );
 static int yf_do_cst_dump(struct yf_parse_node * tree);
+static void yf_print_profile(struct yf_compilation_data *);
+static void yf_print_mem_report(void);
 static int yf_cleanup(struct yf_compilation_data *);
 
+/* Where the build database is kept - in a project, or else in the working
+directory. */
+#define YF_BUILD_DB_PATH "bin/build.db"
+#define YF_FILE_BUILD_DIR ".yfc"
+#define YF_FILE_BUILD_DB_PATH YF_FILE_BUILD_DIR "/build.db"
+
 static inline const char * str_or_null(const char * s) {
     return s ? s : "(null)";
 }
@@ -86,6 +119,63 @@ static int yf_create_compilation_data(struct yf_args * args, struct yf_compilati
     }
 }
 
+/**
+ * Run a job that the compiler does itself, or with --simulate-run, just print
+ * it.
+ */
+static int yf_run_job(
+    struct yf_compilation_data * compilation,
+    struct yf_args * args,
+    struct yf_compilation_job * job
+) {
+
+    switch (job->type) {
+        case YF_COMPILATION_ANALYSE:
+            if (args->dump_commands) {
+                yf_dump_compile_job((struct yf_compile_analyse_job *)job, "ANALYSE");
+            }
+            if (!args->simulate_run) {
+                return yfc_run_frontend_build_symtable(compilation, (struct yf_compile_analyse_job *)job);
+            }
+            return 0;
+
+        case YF_COMPILATION_INDEX:
+            if (args->dump_commands) {
+                fputs("INDEX\n", YF_OUTPUT_STREAM);
+            }
+            if (!args->simulate_run) {
+                return yfc_build_symbol_index(compilation, (struct yf_compile_index_job *)job);
+            }
+            return 0;
+
+        case YF_COMPILATION_COMPILE:
+            if (args->dump_commands) {
+                yf_dump_compile_job(((struct yf_compile_compile_job *)job)->unit, "COMPILE");
+            }
+            if (!args->simulate_run) {
+                return yfc_validate_compile(compilation, (struct yf_compile_compile_job *)job);
+            }
+            return 0;
+
+        case YF_COMPILATION_UNITY:
+            if (args->dump_commands) {
+                fprintf(YF_OUTPUT_STREAM, "UNITY %s\n",
+                    ((struct yf_compile_unity_job *)job)->output_file);
+            }
+            if (!args->simulate_run) {
+                return yfc_generate_unity(compilation, (struct yf_compile_unity_job *)job);
+            }
+            return 0;
+
+        case YF_COMPILATION_EXEC:
+            /* Commands are started by the scheduler. */
+            break;
+    }
+
+    return 2;
+
+}
+
 /**
  * This is it. This is the actual compile function for a set of arguments. It
  * just defers compilation to one of two functions, depending on whether
@@ -94,54 +184,43 @@ static int yf_create_compilation_data(struct yf_args * args, struct yf_compilati
 int yf_run_compiler(struct yf_args * args) {
 
     struct yf_compilation_data compilation;
-    struct yf_compilation_job * job;
     int res = 0;
 
+    if (args->profile)
+        yf_profile_enable();
+
     res = yf_create_compilation_data(args, &compilation);
 
     if (res)
         return res;
 
-    /* Execute jobs */
-    YF_LIST_FOREACH(compilation.jobs, job) {
-        switch (job->type) {
-            case YF_COMPILATION_ANALYSE:
-                if (args->dump_commands) {
-                    yf_dump_compile_job((struct yf_compile_analyse_job *)job, "ANALYSE");
-                }
-                if (!args->simulate_run) {
-                    res = yfc_run_frontend_build_symtable(&compilation, (struct yf_compile_analyse_job *)job);
-                }
-                break;
+    res = yf_run_jobs(&compilation, args, yf_run_job);
 
-            case YF_COMPILATION_COMPILE:
-                if (args->dump_commands) {
-                    yf_dump_compile_job(((struct yf_compile_compile_job *)job)->unit, "COMPILE");
-                }
-                if (!args->simulate_run) {
-                    res = yfc_validate_compile(&compilation, (struct yf_compile_compile_job *)job);
-                }
-                break;
+    /* Saved even if the build failed, so that what did succeed is kept. */
+    if (compilation.build_db && !args->simulate_run) {
+        if (!args->project)
+            mkdir(YF_FILE_BUILD_DIR, 0755);
+        if (yf_build_db_save(compilation.build_db))
+            YF_PRINT_WARNING(
+                "Could not write build database %s", compilation.build_db->path
+            );
+    }
 
-            case YF_COMPILATION_EXEC:
-                if (args->dump_commands) {
-                    yf_print_command((struct yf_compile_exec_job *)job);
-                }
-                if (!args->simulate_run) {
-                    res = yf_exec_command((struct yf_compile_exec_job *)job);
-                }
-                break;
+    /* Written even if the build failed - that's when it's most useful. */
+    if (args->trace_out && yf_write_trace(args->trace_out, &compilation))
+        YF_PRINT_WARNING("Could not write trace to %s", args->trace_out);
 
-        }
-
-        if (res)
-            break;
-    }
+    if (args->profile)
+        yf_print_profile(&compilation);
 
     yf_cleanup(&compilation);
     yf_free((void *)args->selected_compiler);
     yf_list_destroy(&args->files, false);
 
+    /* Printed last, so that what's still live is what we've leaked. */
+    if (args->mem_report)
+        yf_print_mem_report();
+
     return res;
 
 }
@@ -154,8 +233,13 @@ static int yf_create_compiler_jobs(
 
     struct yf_compilation_unit_info * fdata;
     struct yf_compile_analyse_job * ujob;
+    struct yf_compile_index_job * ijob = NULL;
     struct yf_compile_compile_job * cjob;
+    struct yf_compile_unity_job * shard;
     bool has_compiled_files = false;
+    bool needs_index = false, needs_entry_point = false;
+    struct yf_vec shards;
+    size_t num_units = 0, i;
 
     yf_backend_find_compiler(args);
 
@@ -165,18 +249,38 @@ static int yf_create_compiler_jobs(
     /* Fill project info */
     compilation->project_name = data->project_name;
     yf_list_init(&compilation->jobs);
-    yfh_init(&compilation->symtables);
+    memset(&compilation->symindex, 0, sizeof compilation->symindex);
     yf_list_init(&compilation->garbage);
+    compilation->build_db = NULL;
+    compilation->interfaces_hash = 0;
+    compilation->instrument = args->instrument;
+
+    if (yf_backend_set_up_pgo(compilation, args))
+        return 1;
+
+    /* Outside of a project, the database is only there for the compile and
+    link commands, so it's only kept when they run - yfc doesn't leave
+    anything behind in a directory it only checks or generates code in. */
+    if (args->project || (args->run_c_comp && !args->tdump && !args->cstdump
+        && !args->just_semantics)) {
+        compilation->build_db = yf_calloc(1, sizeof *compilation->build_db);
+        if (!compilation->build_db || yf_build_db_load(compilation->build_db,
+            args->project ? YF_BUILD_DB_PATH : YF_FILE_BUILD_DB_PATH)) {
+            YF_PRINT_ERROR("Could not allocate build database");
+            return 3;
+        }
+    }
 
     struct yfh_cursor cursor;
     for (yfh_cursor_init(&cursor, &data->files); !yfh_cursor_next(&cursor); ) {
         yfh_cursor_get(&cursor, NULL, (void **)&fdata);
 
-        ujob = malloc(sizeof(struct yf_compile_analyse_job));
+        ujob = yf_malloc(sizeof(struct yf_compile_analyse_job));
         memset(ujob, 0, sizeof(struct yf_compile_analyse_job));
 
         ujob->job.type = YF_COMPILATION_ANALYSE;
         ujob->unit_info = fdata;
+        ujob->profile.name = fdata->file_name;
 
         ujob->stage =
             args->tdump          ? YF_COMPILE_LEXONLY     :
@@ -185,8 +289,37 @@ static int yf_create_compiler_jobs(
            !args->run_c_comp     ? YF_COMPILE_CODEGENONLY :
                                    YF_COMPILE_FULL;
 
+        if (ujob->stage >= YF_COMPILE_ANALYSEONLY)
+            needs_index = true;
+        if (ujob->stage >= YF_COMPILE_CODEGENONLY)
+            needs_entry_point = true;
+
         yfh_cursor_set(&cursor, ujob); // Set the job for further stages
         yf_list_add(&compilation->jobs, ujob);
+        ++num_units;
+    }
+
+    /* With --unity, the units are dealt out to at most that many files. */
+    yf_vec_init(&shards);
+    if (needs_entry_point) {
+        for (i = 0; i < (size_t) args->unity && i < num_units; ++i) {
+            shard = yf_calloc(1, sizeof(struct yf_compile_unity_job));
+            shard->job.type = YF_COMPILATION_UNITY;
+            yf_vec_add(&shards, shard);
+        }
+    }
+    num_units = 0;
+
+    /* Validation needs the symbols of every unit, so index them all first. */
+    if (needs_index) {
+        ijob = yf_calloc(1, sizeof(struct yf_compile_index_job));
+        ijob->job.type = YF_COMPILATION_INDEX;
+        ijob->need_entry_point = needs_entry_point;
+        for (yfh_cursor_init(&cursor, &data->files); !yfh_cursor_next(&cursor); ) {
+            yfh_cursor_get(&cursor, NULL, (void **)&ujob);
+            yf_job_add_dep(&ijob->job, &ujob->job);
+        }
+        yf_list_add(&compilation->jobs, ijob);
     }
 
     for (yfh_cursor_init(&cursor, &data->files); !yfh_cursor_next(&cursor); ) {
@@ -194,18 +327,33 @@ static int yf_create_compiler_jobs(
         if (ujob->stage < YF_COMPILE_ANALYSEONLY)
             continue;
 
-        cjob = malloc(sizeof(struct yf_compile_compile_job));
+        cjob = yf_calloc(1, sizeof(struct yf_compile_compile_job));
         cjob->job.type = YF_COMPILATION_COMPILE;
         cjob->unit = ujob;
+        yf_job_add_dep(&cjob->job, &ijob->job);
         yf_list_add(&compilation->jobs, cjob);
 
-        if (ujob->stage >= YF_COMPILE_CODEGENONLY) {
-            char * object_file = yf_backend_add_compile_job(compilation, args, ujob->unit_info);
+        if (yf_vec_count(&shards)) {
+            shard = yf_vec_get(&shards, num_units++ % yf_vec_count(&shards));
+            cjob->shard = shard;
+            yf_vec_add(&shard->units, cjob);
+            yf_job_add_dep(&shard->job, &cjob->job);
+            has_compiled_files = true;
+        } else if (ujob->stage >= YF_COMPILE_CODEGENONLY) {
+            char * object_file = yf_backend_add_compile_job(compilation, args, cjob);
             yf_list_add(&link_objs, object_file);
             has_compiled_files = true;
         }
     }
 
+    for (i = 0; i < yf_vec_count(&shards); ++i) {
+        shard = yf_vec_get(&shards, i);
+        yf_list_add(&compilation->jobs, shard);
+        yf_list_add(&link_objs,
+            yf_backend_add_unity_job(compilation, args, shard, i));
+    }
+    yf_vec_destroy(&shards, 0);
+
     if (has_compiled_files && ujob->stage >= YF_COMPILE_FULL) {
         yf_backend_add_link_job(compilation, args, &link_objs);
     }
@@ -217,110 +365,6 @@ static int yf_create_compiler_jobs(
 
 }
 
-#if 0
-static int yf_run_compiler_on_data(
-    struct yf_project_compilation_data * data,
-    struct yf_args * args
-) {
-
-/* Local defines for profiling */
-#define BEGIN_PROFILE() \
-    gettimeofday(&step_begin, NULL)
-
-#define END_PROFILE(step_name) do { \
-    gettimeofday(&step_end, NULL); \
-    if (args->profile) { \
-        time_for_step = (step_end.tv_sec - step_begin.tv_sec) * 1000000 + \
-            (step_end.tv_usec - step_begin.tv_usec); \
-        YF_PRINT_DEFAULT( \
-            "Time for %s: %f seconds", \
-            step_name, \
-            ( (double) time_for_step ) / 1000000.0 \
-        ); \
-    } \
-} while (0)
-
-    int i, err = 0;
-    struct yf_file_compilation_data * fdata;
-
-    /* For profiling purposes only */
-    double time_for_step, time_total;
-    struct timeval total_begin, step_begin, step_end, total_end;
-
-    /* Parse the frontend for all and create symtabs */
-    BEGIN_PROFILE();
-    total_begin = step_begin;
-    for (i = 0; i < YFH_BUCKETS; ++i) {
-        fdata = data->files->buckets[i].value;
-        if (!fdata) continue;
-        fdata->error = 0; /* Starting off clean */
-        if (yf_run_frontend(fdata, args)) {
-            fdata->error = 1;
-        }
-        if (args->cstdump || args->tdump) {
-            return fdata->error;
-        }
-    }
-    END_PROFILE("parsing");
-
-    BEGIN_PROFILE();
-    for (i = 0; i < YFH_BUCKETS; ++i) {
-        fdata = data->files->buckets[i].value;
-        if (!fdata) continue;
-        if (!fdata->error) {
-            if (yf_build_symtab(fdata)) {
-                fdata->error = 1;
-                err = 1;
-            } else {
-                fdata->error = 0;
-            }
-        }
-    }
-    END_PROFILE("building symtabs");
-
-    /* TODO - set flags so we can efficiently avoid compiling the bad ones */
-
-    /* Now validate everything. */
-    BEGIN_PROFILE();
-    for (i = 0; i < YFH_BUCKETS; ++i) {
-        fdata = data->files->buckets[i].value;
-        if (!fdata) continue;
-        if (!fdata->error
-            && yf_validate_ast(
-                data, fdata, args
-            )
-        ) {
-            fdata->error = 1;
-            err = 1;
-        }
-    }
-    END_PROFILE("validating code");
-
-    /* Finally, generate code. */
-    if (!args->just_semantics) {
-        BEGIN_PROFILE();
-        err = yf_run_backend(data, args);
-        gettimeofday(&step_end, NULL);
-        END_PROFILE("generating code");
-    }
-    total_end = step_end;
-    if (args->profile) {
-        time_total = (total_end.tv_sec - total_begin.tv_sec) * 1000000 +
-            (total_end.tv_usec - total_begin.tv_usec);
-        YF_PRINT_DEFAULT(
-            "Total time: %f seconds",
-            ( (double) time_total ) / 1000000.0
-        );
-    }
-
-#undef BEGIN_PROFILE
-#undef END_PROFILE
-
-    return err;
-
-}
-#endif
-
 static int yf_compile_project(struct yf_args * args, struct yf_compilation_data * compilation) {
 
     struct yf_project_compilation_data data;
@@ -391,7 +435,7 @@ static int yf_compile_files(struct yf_args * args, struct yf_compilation_data *
     yfh_init(&data.files);
 
     YF_LIST_FOREACH(args->files, fname) {
-        fdata = malloc(sizeof(struct yf_compilation_unit_info));
+        fdata = yf_malloc(sizeof(struct yf_compilation_unit_info));
         memset(fdata, 0, sizeof (struct yf_compilation_unit_info));
         fdata->file_name = yf_strdup(fname);
         fdata->parse_anew = 1;
@@ -409,25 +453,195 @@ static int yfc_validate_compile(
 ) {
 
     struct yf_compile_analyse_job * adata = udata->unit;
+    struct yf_build_db * db = pdata->build_db;
+    const char * output = adata->unit_info->output_file;
     int retval;
+    uint64_t start, inputs = 0, version = 0;
+
+    /* With --unity, the code is generated for the whole file at once - this
+    only validates, and not even that if the file is current. */
+    if (udata->shard && yf_unity_current(pdata, udata->shard)) {
+        yf_cleanup_cst(&adata->parse_tree);
+        adata->parse_tree.type = YFCS_EMPTY;
+        return 0;
+    }
 
+    /* The C code of a unit depends on its own source and on what it can see
+    of the others - if none of that changed, neither has the code. */
+    if (db && adata->stage >= YF_COMPILE_CODEGENONLY && !udata->in_memory
+        && !udata->shard) {
+        inputs = yf_hash(&adata->source_hash, sizeof adata->source_hash,
+            pdata->interfaces_hash);
+        version = yf_codegen_version(pdata);
+        if (yf_build_db_is_current(db, output, inputs, version)) {
+            yf_cleanup_cst(&adata->parse_tree);
+            adata->parse_tree.type = YFCS_EMPTY;
+            return 0;
+        }
+        yf_build_db_forget(db, output);
+    }
+
+    yf_alloc_set_tag(YF_ALLOC_AST);
+    start = yf_profile_begin();
     retval = yf_validate_ast(pdata, adata);
+    yf_profile_end(&adata->profile, YF_PHASE_VALIDATE, start);
+    yf_alloc_set_tag(YF_ALLOC_DRIVER);
+
+    /* Nothing refers to the parse tree after validation, so free it now
+    instead of keeping every unit's tree until the end of the build. */
+    yf_cleanup_cst(&adata->parse_tree);
+    adata->parse_tree.type = YFCS_EMPTY;
+
     if (retval)
         return retval;
 
     if (adata->stage >= YF_COMPILE_CODEGENONLY) {
-        /* This check must go inside and return, or else we get errors about it
-        once for every file. */
-        if (yf_ensure_entry_point(pdata)) {
-            return 1;
+        start = yf_profile_begin();
+        yfs_fold(adata);
+        yf_profile_end(&adata->profile, YF_PHASE_FOLD, start);
+    }
+
+    if (adata->stage >= YF_COMPILE_CODEGENONLY && !udata->shard) {
+        start = yf_profile_begin();
+        retval = yf_backend_generate_code(pdata, udata);
+        yf_profile_end(&adata->profile, YF_PHASE_CODEGEN, start);
+        if (!retval && db && !udata->in_memory)
+            yf_build_db_made(db, output, inputs, version);
+    }
+
+    return retval;
+
+}
+
+/**
+ * Generated code depends on the generator, and on its options - code from
+ * another version of yfc, or with other options, is never current.
+ */
+static uint64_t yf_codegen_version(struct yf_compilation_data * pdata) {
+    uint64_t version = YFG_VERSION;
+    return yf_hash(&version, sizeof version, pdata->instrument);
+}
+
+/**
+ * Check whether the code of a --unity file is current: like a unit's, it
+ * depends on the sources of its units and on what they can see of others.
+ * Only checked once, by whichever of its jobs runs first - every unit's source
+ * has been hashed by then.
+ */
+static bool yf_unity_current(
+    struct yf_compilation_data * pdata,
+    struct yf_compile_unity_job * shard
+) {
+
+    struct yf_compile_compile_job * cjob;
+    struct yf_compile_analyse_job * adata;
+    uint64_t inputs = pdata->interfaces_hash;
+
+    if (!pdata->build_db || shard->in_memory)
+        return false;
+
+    if (!shard->checked) {
+        YF_VEC_FOREACH(shard->units, cjob) {
+            adata = cjob->unit;
+            inputs = yf_hash_str(adata->unit_info->file_name, inputs);
+            inputs = yf_hash(
+                &adata->source_hash, sizeof adata->source_hash, inputs
+            );
         }
-        retval = yf_backend_generate_code(adata);
+        shard->inputs = inputs;
+        shard->current = yf_build_db_is_current(
+            pdata->build_db, shard->output_file, inputs,
+            yf_codegen_version(pdata)
+        );
+        shard->checked = true;
+    }
+
+    return shard->current;
+
+}
+
+/**
+ * Generate the code of a --unity file, once all of its units are validated.
+ */
+static int yfc_generate_unity(
+    struct yf_compilation_data * pdata,
+    struct yf_compile_unity_job * shard
+) {
+
+    struct yf_build_db * db = shard->in_memory ? NULL : pdata->build_db;
+    int retval;
+    uint64_t start;
+
+    if (yf_unity_current(pdata, shard))
+        return 0;
+    if (db)
+        yf_build_db_forget(db, shard->output_file);
+
+    start = yf_profile_begin();
+    retval = yf_backend_generate_unity(pdata, shard);
+    yf_profile_end(NULL, YF_PHASE_CODEGEN, start);
+
+    if (!retval && db) {
+        yf_build_db_made(db, shard->output_file, shard->inputs,
+            yf_codegen_version(pdata));
     }
 
     return retval;
 
 }
 
+/**
+ * Build the project symbol index, once every unit has its symbol table. The
+ * entry point is checked here, so that it's only reported once.
+ */
+static int yfc_build_symbol_index(
+    struct yf_compilation_data * pdata,
+    struct yf_compile_index_job * ijob
+) {
+
+    struct yf_compilation_job * job;
+    struct yf_compile_analyse_job * ujob;
+    int retval;
+    uint64_t start;
+
+    /* Summed, so that the order of the units doesn't matter. */
+    YF_LIST_FOREACH(pdata->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        ujob = (struct yf_compile_analyse_job *)job;
+        pdata->interfaces_hash += yf_hash_str(
+            ujob->unit_info->file_name, ujob->interface_hash
+        );
+    }
+
+    yf_alloc_set_tag(YF_ALLOC_SYMTAB);
+    start = yf_profile_begin();
+    retval = yfs_build_symbol_index(&pdata->symindex, pdata);
+    yf_profile_end(NULL, YF_PHASE_INDEX, start);
+    yf_alloc_set_tag(YF_ALLOC_DRIVER);
+    if (retval)
+        return retval;
+
+    if (ijob->need_entry_point) {
+        if (yf_ensure_entry_point(pdata))
+            return 1;
+        /* Code is only generated for what the program can reach. */
+        start = yf_profile_begin();
+        retval = yfs_index_mark_reachable(&pdata->symindex, pdata);
+        yf_profile_end(NULL, YF_PHASE_INDEX, start);
+        if (retval)
+            return retval;
+        yf_backend_drop_dead_units(pdata);
+    }
+
+    /* Whether a function is static, or generated at all, depends on the
+    other units, too. */
+    pdata->interfaces_hash += pdata->symindex.usage_hash;
+
+    return 0;
+
+}
+
 /**
  * Run the lexing and parsing on one file and build a symtable of the file.
  */
@@ -444,6 +658,7 @@ static int yfc_run_frontend_build_symtable(
     struct yf_compilation_unit_info * file = data->unit_info;
 
     int retval;
+    uint64_t start;
 
     file_name = file->parse_anew ? file->file_name : file->sym_file;
     file_src = fopen(
@@ -472,24 +687,69 @@ static int yfc_run_frontend_build_symtable(
     yfl_init(&lexer, &input);
 
     if (data->stage == YF_COMPILE_LEXONLY) {
-        return dump_tokens(&lexer);
+        yf_alloc_set_tag(YF_ALLOC_LEXER);
+        retval = dump_tokens(&lexer);
+        yf_alloc_set_tag(YF_ALLOC_DRIVER);
+        return retval;
     } else {
-        if ( (retval = yf_parse(&lexer, &data->parse_tree)) ) {
+        yf_alloc_set_tag(YF_ALLOC_PARSER);
+        start = yf_profile_begin();
+        retval = yf_parse(&lexer, &data->parse_tree);
+        yf_alloc_set_tag(YF_ALLOC_DRIVER);
+        if (yf_profiling) {
+            /* The lexer timed itself - the rest is parsing. */
+            yf_profile_add(&data->profile, YF_PHASE_LEX, lexer.lex_ns);
+            yf_profile_add(
+                &data->profile, YF_PHASE_PARSE,
+                yf_profile_now() - start - lexer.lex_ns
+            );
+        }
+        data->profile.lines = lexer.loc.line;
+        data->profile.tokens = lexer.num_tokens;
+        if (retval) {
             YF_PRINT_ERROR("Error parsing file %s", file->file_name);
             return retval;
         }
         if (data->stage == YF_COMPILE_PARSEONLY) {
             retval = yf_do_cst_dump(&data->parse_tree);
         } else {
+            yf_alloc_set_tag(YF_ALLOC_SYMTAB);
+            start = yf_profile_begin();
             retval = yf_build_symtab(data);
-            if (!retval && data->unit_info->file_prefix)
-                yfh_set(&compilation->symtables, data->unit_info->file_prefix, &data->symtab);
+            yf_profile_end(&data->profile, YF_PHASE_SYMTAB, start);
+            yf_alloc_set_tag(YF_ALLOC_DRIVER);
+            if (!retval && compilation->build_db)
+                retval = yf_record_unit(compilation->build_db, data);
         }
         return retval;
     }
 
 }
 
+/**
+ * Remember what a unit's source and interface hashed to, for deciding later
+ * whether its C code needs to be generated again.
+ */
+static int yf_record_unit(
+    struct yf_build_db * db, struct yf_compile_analyse_job * data
+) {
+
+    const char * file_name = data->unit_info->file_name;
+    struct yf_build_record * rec;
+
+    data->interface_hash = yfs_symtab_interface_hash(&data->symtab);
+    if (yf_build_db_file_hash(db, file_name, &data->source_hash)) {
+        YF_PRINT_ERROR("Could not read file %s", file_name);
+        return 1;
+    }
+    if (!(rec = yf_build_db_record(db, file_name)))
+        return 3;
+    rec->interface = data->interface_hash;
+
+    return 0;
+
+}
+
 /**
  * Stuff the project compilation data with all files that need to be compiled.
  * See yfd_find_projfiles for return code.
@@ -553,6 +813,52 @@ static int yf_validate_ast(
 
 }
 
+/**
+ * Print the phase timings of every unit, followed by how many scope probes the
+ * scope filters saved.
+ */
+static void yf_print_profile(struct yf_compilation_data * data) {
+
+    struct yf_compilation_job * job;
+    struct yf_compile_analyse_job * ujob;
+    struct yfs_lookup_stats total = { 0, 0 };
+    struct yf_vec units;
+
+    yf_vec_init(&units);
+
+    YF_LIST_FOREACH(data->jobs, job) {
+        if (job->type == YF_COMPILATION_ANALYSE) {
+            ujob = (struct yf_compile_analyse_job *)job;
+            total.probes += ujob->lookups.probes;
+            total.skipped += ujob->lookups.skipped;
+            yf_vec_add(&units, &ujob->profile);
+        }
+    }
+
+    yf_profile_report(
+        YF_OUTPUT_STREAM,
+        (struct yf_profile_unit * const *) yf_vec_data(&units),
+        yf_vec_count(&units)
+    );
+    yf_vec_destroy(&units, 0);
+
+    YF_PRINT_DEFAULT(
+        "Scope lookups: %lu scopes searched, %lu probes avoided by filters",
+        total.probes, total.skipped
+    );
+
+}
+
+static void yf_print_mem_report(void) {
+
+    long rss = proc_peak_rss_kb();
+
+    yf_alloc_report(YF_OUTPUT_STREAM);
+    if (rss)
+        YF_PRINT_DEFAULT("Peak RSS: %ld KiB", rss);
+
+}
+
 /**
  * Destroy all objects and whatnot.
  */
@@ -561,6 +867,7 @@ static int yf_cleanup(struct yf_compilation_data * data) {
     struct yf_compilation_job * job;
 
     YF_LIST_FOREACH(data->jobs, job) {
+        yf_vec_destroy(&job->dependents, 0);
         switch (job->type) {
             case YF_COMPILATION_ANALYSE: {
                 struct yf_compile_analyse_job * adata = (struct yf_compile_analyse_job *)job;
@@ -575,6 +882,8 @@ static int yf_cleanup(struct yf_compilation_data * data) {
                 // Will be EMPTY if unset
                 yf_cleanup_cst(&adata->parse_tree);
                 yf_cleanup_ast(&adata->ast_tree);
+                yf_intern_destroy(&adata->strings);
+                yf_vec_destroy(&adata->imports, 0);
 
                 yf_free(fdata->file_name);
                 yf_free(fdata->file_prefix);
@@ -589,13 +898,32 @@ static int yf_cleanup(struct yf_compilation_data * data) {
                 break;
 
             case YF_COMPILATION_COMPILE:
+                yf_strbuf_destroy(&((struct yf_compile_compile_job *)job)->code);
+                break;
+
+            case YF_COMPILATION_UNITY: {
+                struct yf_compile_unity_job * shard = (struct yf_compile_unity_job *)job;
+                yf_vec_destroy(&shard->units, 0);
+                yf_strbuf_destroy(&shard->code);
+                yf_free(shard->output_file);
+                break;
+            }
+
+            case YF_COMPILATION_INDEX:
                 break;
         }
     }
 
+    if (data->build_db) {
+        yf_build_db_destroy(data->build_db);
+        yf_free(data->build_db);
+    }
+
     yf_free(data->project_name);
+    yf_free(data->pgo_dir_flag);
+    yf_free(data->pgo_prefix);
     yf_list_destroy(&data->jobs, true);
-    yfh_destroy(&data->symtables, NULL);
+    yfs_destroy_symbol_index(&data->symindex);
     yf_list_destroy(&data->garbage, true);
 
     return 0;
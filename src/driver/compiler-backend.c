@@ -1,15 +1,24 @@
 #include "compiler-backend.h"
 
+#include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h> /* getcwd */
 
 #include <api/compilation-data.h>
 #include <api/generation.h>
+#include <driver/builddb.h>
 #include <driver/c-compiler.h>
 #include <driver/os.h>
+#include <driver/scheduler.h>
 #include <gen/gen.h>
 #include <util/allocator.h>
+#include <util/hash.h>
 #include <util/list.h>
 #include <util/hashmap.h>
+#include <util/profile.h>
+#include <util/strbuf.h>
+#include <util/vec.h>
 #include <util/yfc-out.h>
 
 static void dump_command(const char * const cmd[]) {
@@ -30,29 +39,182 @@ static void dump_command(const char * const cmd[]) {
 void yf_print_command(
     struct yf_compile_exec_job * job
 ) {
+    if (job->skip)
+        fputs("(unused) ", YF_OUTPUT_STREAM);
+    else if (job->cached)
+        fputs("(cached) ", YF_OUTPUT_STREAM);
     dump_command(job->command);
 }
 
-int yf_exec_command(
-    struct yf_compile_exec_job * job
+/**
+ * Internal - hash all arguments of a command, so that changing any flag makes
+ * the output out of date.
+ */
+static uint64_t yf_command_hash(struct yf_compile_exec_job * job) {
+    uint64_t hash = 0;
+    const char ** arg;
+    for (arg = job->command; *arg; ++arg)
+        hash = yf_hash_str(*arg, hash);
+    return hash;
+}
+
+/**
+ * Internal - check a command against the build database: the output must be
+ * what the same command last made from inputs with the same contents.
+ */
+static bool yf_command_made(
+    struct yf_build_db * db, struct yf_compile_exec_job * job
 ) {
 
-    static const file_open_descriptor descs[] = {
+    uint64_t hash, inputs = 0;
+    size_t i;
+
+    if (job->stdin_data)
+        inputs = yf_hash(job->stdin_data->data, job->stdin_data->len, 0);
+
+    for (i = 0; i < job->num_inputs; ++i) {
+        if (yf_build_db_file_hash(db, job->inputs[i], &hash))
+            return false;
+        inputs = yf_hash(&hash, sizeof hash, inputs);
+    }
+    job->inputs_hash = inputs;
+
+    return yf_build_db_is_current(
+        db, job->output, inputs, yf_command_hash(job)
+    );
+
+}
+
+bool yf_command_up_to_date(
+    struct yf_compilation_data * data, struct yf_compile_exec_job * job
+) {
+    return job->output && data->build_db
+        && yf_command_made(data->build_db, job);
+}
+
+int yf_start_command(
+    struct yf_compilation_data * data,
+    struct yf_compile_exec_job * job,
+    process_handle * proc
+) {
+
+    file_open_descriptor descs[] = {
         { 0, YF_OS_FILE_DEVNULL },
         { 1, YF_OS_FILE_DEVNULL },
         { 2, YF_OS_FILE_DEVNULL },
         { -1, -1 },
     };
 
-    /*if (args->dump_commands) {
-        fputs("Compile command: ", YF_OUTPUT_STREAM);
-        dump_command(compile_cmd);
-    }*/
-    if (proc_exec(job->command, descs, 0) != 0) {
+    int pipe_fds[2];
+    int failed;
+
+    /* If the command fails or is killed, the output must not look up to
+    date next time, so it's only recorded once it has succeeded. */
+    if (job->output && data->build_db)
+        yf_build_db_forget(data->build_db, job->output);
+
+    if (job->stdin_data) {
+        if (pipe_open(pipe_fds)) {
+            YF_PRINT_ERROR("Could not open a pipe to the C compiler");
+            return 2;
+        }
+        descs[0].source_fd = pipe_fds[0];
+    }
+
+    memset(proc, 0, sizeof *proc);
+    failed = proc_open(proc, job->command, descs, 0);
+
+    if (job->stdin_data) {
+        fd_close(pipe_fds[0]);
+        job->stdin_fd = pipe_fds[1];
+        job->stdin_written = 0;
+        if (failed)
+            yf_drop_command_input(job);
+        else
+            yf_feed_command(job, proc);
+    }
+
+    if (failed) {
+        YF_PRINT_ERROR("Compilation command failed");
+        return 2;
+    }
+
+    return 0;
+}
+
+void yf_feed_command(
+    struct yf_compile_exec_job * job, process_handle * proc
+) {
+
+    long written;
+
+    if (!job->stdin_data || job->stdin_fd < 0)
+        return;
+
+    written = fd_write_some(job->stdin_fd,
+        job->stdin_data->data + job->stdin_written,
+        job->stdin_data->len - job->stdin_written
+    );
+
+    /* If the input can't all be written, the output mustn't be made from
+    what was - the rest is kept, so that the command is seen to have
+    failed even if it exited by itself. */
+    if (written < 0) {
+        proc_kill(proc);
+        fd_close(job->stdin_fd);
+        job->stdin_fd = -1;
+        return;
+    }
+
+    job->stdin_written += written;
+    if (job->stdin_written == job->stdin_data->len)
+        yf_drop_command_input(job);
+
+}
+
+void yf_drop_command_input(struct yf_compile_exec_job * job) {
+    if (!job->stdin_data)
+        return;
+    if (job->stdin_fd >= 0)
+        fd_close(job->stdin_fd);
+    yf_strbuf_destroy(job->stdin_data);
+    job->stdin_data = NULL;
+}
+
+int yf_finish_command(
+    struct yf_compilation_data * data,
+    struct yf_compile_exec_job * job,
+    process_handle * proc
+) {
+
+    yf_profile_end(
+        job->unit ? &job->unit->profile : NULL, job->phase, job->job.start_ns
+    );
+
+    job->exit_code = proc->exit_code;
+    job->user_us = proc->user_us;
+    job->sys_us = proc->sys_us;
+    job->maxrss_kb = proc->maxrss_kb;
+
+    /* A command that exits before reading all of its input didn't make its
+    output from all of it. */
+    if (job->stdin_data) {
+        yf_drop_command_input(job);
+        if (job->exit_code == 0)
+            job->exit_code = 1;
+    }
+
+    if (job->exit_code != 0) {
         YF_PRINT_ERROR("Compilation command failed");
         return 2;
     }
 
+    if (job->output && data->build_db) {
+        yf_build_db_made(
+            data->build_db, job->output, job->inputs_hash, yf_command_hash(job)
+        );
+    }
+
     return 0;
 }
 
@@ -113,11 +275,108 @@ static int create_output_file_name(
 }
 
 /**
- * Generate C code
+ * Because we create the output file in the form of 'bin/c/foo/bar/baz.yf',
+ * we need to first mkdir() the enclosing directory, if it doesn't already
+ * exist. To do that, we would replace the last slash with a \0, mkdir() the
+ * path, and set it back.
+ * However, we have to create ALL enclosing folders first, so we need to get
+ * all slashes from left to right, and do this recursively.
+ */
+static int create_all_parent_dirs(char * path) {
+    char * slashloc = path;
+    while (slashloc) {
+        slashloc = strchr(slashloc, '/');
+        if (!slashloc)
+            break;
+        *slashloc = '\0';
+        mkdir(path, 0755);
+        /* Now, we move the loc one forward, and search for the new slash. */
+        *slashloc = '/';
+        ++slashloc;
+    }
+    return 0;
+}
+
+/**
+ * Internal - write a whole buffer to a file, through a temporary file so that
+ * the file is never seen half-written.
+ */
+static int yf_write_file(const char * path, struct yf_strbuf * buf) {
+
+    size_t len = strlen(path);
+    char * tmp_path;
+    FILE * out;
+    int failed;
+
+    if (!(tmp_path = yf_malloc(len + sizeof ".tmp")))
+        return 3;
+    memcpy(tmp_path, path, len);
+    memcpy(tmp_path + len, ".tmp", sizeof ".tmp");
+
+    if (!(out = fopen(tmp_path, "wb"))) {
+        yf_free(tmp_path);
+        return 1;
+    }
+
+    failed = fwrite(buf->data, 1, buf->len, out) != buf->len;
+    failed = fclose(out) || failed;
+    failed = failed || file_replace(tmp_path, path);
+    if (failed)
+        remove(tmp_path);
+
+    yf_free(tmp_path);
+    return failed;
+
+}
+
+/**
+ * Internal - write C code, but only if it differs from what's already there -
+ * so that the output keeps its modification time, and the C compiler doesn't
+ * run again for nothing.
+ */
+static int yf_write_c_file(
+    struct yf_build_db * db, char * output, struct yf_strbuf * code
+) {
+
+    uint64_t old_hash;
+    int retval = 0;
+
+    if (yf_build_db_file_hash(db, output, &old_hash)
+        || old_hash != yf_hash(code->data, code->len, 0)) {
+        create_all_parent_dirs(output);
+        if ((retval = yf_write_file(output, code)))
+            YF_PRINT_ERROR("could not write output file %s", output);
+    }
+
+    return retval;
+
+}
+
+/**
+ * Generate C code. It's rendered into memory first, and only written if it
+ * changed.
  */
 static int yf_gen_c(
-    struct yf_compile_analyse_job * fdata, struct yf_gen_info * info) {
-    return yfg_gen(fdata, info);
+    struct yf_build_db * db,
+    struct yf_compile_analyse_job * fdata,
+    struct yf_gen_info * info
+) {
+
+    char * output = fdata->unit_info->output_file;
+    struct yf_strbuf code;
+    int retval;
+
+    yf_strbuf_init(&code);
+    if (yfg_gen(fdata, info, &code)) {
+        YF_PRINT_ERROR("could not generate code for %s", output);
+        yf_strbuf_destroy(&code);
+        return 3;
+    }
+
+    retval = yf_write_c_file(db, output, &code);
+    yf_strbuf_destroy(&code);
+    return retval;
+
 }
 
 /**
@@ -150,42 +409,254 @@ int yf_backend_find_compiler(
 
 }
 
-char * yf_backend_add_compile_job(
+/**
+ * Internal - count the words of a string of flags like "-march=native -g".
+ */
+static size_t yf_count_flags(const char * flags) {
+
+    size_t count = 0;
+
+    while (flags && *flags) {
+        while (*flags == ' ')
+            ++flags;
+        if (!*flags)
+            break;
+        ++count;
+        while (*flags && *flags != ' ')
+            ++flags;
+    }
+
+    return count;
+
+}
+
+/**
+ * Internal - allocate a command with room for 'args' arguments, the words of
+ * 'flags' and the NULL at the end. The words are to be copied to 'text', after
+ * the arguments, so that the command is still freed all at once.
+ */
+static const char ** yf_new_command(
+    size_t args, const char * flags, char ** text
+) {
+
+    const char ** command;
+
+    args += yf_count_flags(flags) + 1;
+    command = yf_malloc(
+        args * sizeof(const char *) + (flags ? strlen(flags) + 1 : 0)
+    );
+    if (command)
+        *text = (char *) (command + args);
+
+    return command;
+
+}
+
+/**
+ * Internal - add the flags that go to both the compiler and the linker, and
+ * the extra flags of either one.
+ * @param compilation where the PGO flags come from
+ * @param it where the next argument of the command goes
+ * @param text where the words of 'flags' are copied, after the arguments
+ * Returns where the argument after these goes.
+ */
+static const char ** yf_add_flags(
     struct yf_compilation_data * compilation,
-    struct yf_args * args,
-    struct yf_compilation_unit_info * unit
+    const char ** it, struct yf_args * args, const char * flags, char * text
 ) {
 
-    if (!unit->output_file || strlen(unit->output_file) == 0)
-        create_output_file_name(unit, args);
+    /* With LTO, the code is generated when linking, so the linker needs to
+    know the optimization level too. */
+    if (args->opt_level)
+        *it++ = args->opt_level;
+    if (args->lto)
+        *it++ = "-flto";
+
+    switch (args->pgo) {
+        case YF_PGO_NONE:
+            break;
+        case YF_PGO_GENERATE:
+            *it++ = "-fprofile-generate";
+            *it++ = compilation->pgo_dir_flag;
+            break;
+        case YF_PGO_USE:
+            *it++ = "-fprofile-use";
+            *it++ = compilation->pgo_dir_flag;
+            /* Code that changed since the profile was collected just isn't
+            optimized with it. */
+            *it++ = "-Wno-error=coverage-mismatch";
+            break;
+    }
+
+    while (flags && *flags) {
+        while (*flags == ' ')
+            ++flags;
+        if (!*flags)
+            break;
+        *it++ = text;
+        while (*flags && *flags != ' ')
+            *text++ = *flags++;
+        *text++ = '\0';
+    }
+
+    return it;
+
+}
+
+/**
+ * Internal - the profile file of an object, where the C compiler looks for it
+ * with --pgo-use. It's named after the absolute path of the object, without
+ * .o and with every '/' turned into '#'.
+ */
+static char * yf_profile_file_name(
+    struct yf_compilation_data * compilation, const char * object_file
+) {
+
+    size_t prefix_len = strlen(compilation->pgo_prefix);
+    size_t len = strlen(object_file) - 2;
+    char * name = yf_malloc(prefix_len + len + sizeof ".gcda");
+    size_t i;
+
+    if (!name)
+        return NULL;
+    memcpy(name, compilation->pgo_prefix, prefix_len);
+    for (i = 0; i < len; ++i)
+        name[prefix_len + i] = object_file[i] == '/' ? '#' : object_file[i];
+    memcpy(name + prefix_len + len, ".gcda", sizeof ".gcda");
+
+    return name;
+
+}
+
+/**
+ * Internal - add a job that runs the C compiler: on a C file, or with
+ * --no-c-files, on code written to its input. The object goes next to where
+ * the C file is, or would be.
+ * @param code the code to compile with --no-c-files, NULL otherwise
+ * @param unit the unit compiled, or NULL if it's more than one
+ * @param dep the job that makes the code
+ * Returns the name of the object file.
+ */
+static char * yf_add_cc_job(
+    struct yf_compilation_data * compilation,
+    struct yf_args * args,
+    const char * c_file,
+    struct yf_strbuf * code,
+    struct yf_compile_analyse_job * unit,
+    struct yf_compilation_job * dep
+) {
 
     struct yf_compile_exec_job * cjob;
+    const char ** it, ** inputs;
+    char * flags_text, * profile;
+    int64_t mtime;
 
     /* Rewite file name foo.c to have foo.o */
-    size_t fname_len = strlen(unit->output_file);
+    size_t fname_len = strlen(c_file);
     char * object_file = yf_malloc(fname_len + 1);
-    memcpy(object_file, unit->output_file, fname_len + 1);
+    memcpy(object_file, c_file, fname_len + 1);
     object_file[fname_len - 1] = 'o';
 
-    cjob = malloc(sizeof(struct yf_compile_exec_job));
+    cjob = yf_calloc(1, sizeof(struct yf_compile_exec_job));
     cjob->job.type = YF_COMPILATION_EXEC;
+    cjob->phase = YF_PHASE_CC;
+    cjob->unit = unit;
+
+    /* Where gcc -c foo.c -o foo.o is stored - or with --no-c-files,
+    gcc -c -x c - -o foo.o, which reads the code from a pipe - followed by
+    the optimization flags and --cflags */
+    cjob->command = yf_new_command(13, args->cflags, &flags_text);
+    it = cjob->command;
+    *it++ = args->selected_compiler;
+    *it++ = "-c";
+    if (code) {
+        *it++ = "-x";
+        *it++ = "c";
+        *it++ = "-";
+    } else {
+        *it++ = c_file;
+    }
+    *it++ = "-o";
+    *it++ = object_file;
+    *it++ = "-fdollars-in-identifiers";
+    it = yf_add_flags(compilation, it, args, args->cflags, flags_text);
+    *it = NULL;
+
+    cjob->output = object_file;
+    if (code) {
+        cjob->stdin_data = code;
+    } else {
+        cjob->inputs = cjob->command + 2;
+        cjob->num_inputs = 1;
+    }
 
-    /* Where gcc -c foo.c -o foo.o is stored */
-    cjob->command = malloc(sizeof(const char *) * 7);
-    cjob->command[0] = args->selected_compiler;
-    cjob->command[1] = "-c";
-    cjob->command[2] = unit->output_file;
-    cjob->command[3] = "-o";
-    cjob->command[4] = object_file;
-    cjob->command[5] = "-fdollars-in-identifiers";
-    cjob->command[6] = NULL;
+    /* With --pgo-use, a new profile has to recompile the object as well. A
+    unit without one isn't optimized with it, and doesn't wait for it. */
+    if (compilation->pgo_prefix
+        && (profile = yf_profile_file_name(compilation, object_file))) {
+        if (!file_info(profile, NULL, &mtime)
+            && (inputs = yf_malloc(2 * sizeof(const char *)))) {
+            if (cjob->num_inputs)
+                inputs[0] = cjob->inputs[0];
+            inputs[cjob->num_inputs++] = profile;
+            cjob->inputs = inputs;
+            yf_list_add(&compilation->garbage, inputs);
+            yf_list_add(&compilation->garbage, profile);
+        } else {
+            yf_free(profile);
+        }
+    }
 
+    /* The C file has to be written first. */
+    yf_job_add_dep(&cjob->job, dep);
     yf_list_add(&compilation->jobs, cjob);
 
     return object_file;
 
 }
 
+char * yf_backend_add_compile_job(
+    struct yf_compilation_data * compilation,
+    struct yf_args * args,
+    struct yf_compile_compile_job * codegen
+) {
+
+    struct yf_compile_analyse_job * ujob = codegen->unit;
+    struct yf_compilation_unit_info * unit = ujob->unit_info;
+
+    if (!unit->output_file || strlen(unit->output_file) == 0)
+        create_output_file_name(unit, args);
+
+    codegen->in_memory = args->no_c_files;
+    return yf_add_cc_job(
+        compilation, args, unit->output_file,
+        codegen->in_memory ? &codegen->code : NULL, ujob, &codegen->job
+    );
+
+}
+
+char * yf_backend_add_unity_job(
+    struct yf_compilation_data * compilation,
+    struct yf_args * args,
+    struct yf_compile_unity_job * shard,
+    int index
+) {
+
+    /* bin/unity/0.c with --project, yfc-unity-0.c otherwise */
+    shard->output_file = yf_malloc(32);
+    if (!shard->output_file)
+        return NULL;
+    snprintf(shard->output_file, 32, "%s%d.c",
+        args->project ? "bin/unity/" : "yfc-unity-", index);
+
+    shard->in_memory = args->no_c_files;
+    return yf_add_cc_job(
+        compilation, args, shard->output_file,
+        shard->in_memory ? &shard->code : NULL, NULL, &shard->job
+    );
+
+}
+
 int yf_backend_add_link_job(
     struct yf_compilation_data * compilation,
     struct yf_args * args,
@@ -194,20 +665,23 @@ int yf_backend_add_link_job(
     /* Where gcc foo1.o foo2.o -o foo is stored */
     const char ** link_cmd;
     struct yf_compile_exec_job * ljob;
+    struct yf_compilation_job * job;
 
     size_t num_objs;
     const char * object_file;
 
     size_t obj_it;
     const char ** it;
+    char * flags_text;
 
     num_objs = 0;
     YF_LIST_FOREACH(*link_objs, object_file) {
         ++num_objs;
     }
 
-    /* <compiler> <objects...> -o <executable> */
-    link_cmd = yf_malloc((4 + num_objs) * sizeof(const char *));
+    /* <compiler> <objects...> -o <executable>, then the optimization flags
+    and --ldflags - after the objects, so that libraries can be given */
+    link_cmd = yf_new_command(8 + num_objs, args->ldflags, &flags_text);
     link_cmd[0] = args->selected_compiler;
 
     it = link_cmd + 1;
@@ -227,19 +701,91 @@ int yf_backend_add_link_job(
         *it++ = "a.out";
     }
 
+    it = yf_add_flags(compilation, it, args, args->ldflags, flags_text);
+
     /* Finish argument list */
     *it = NULL;
 
-    ljob = yf_malloc(sizeof(struct yf_compile_exec_job));
+    ljob = yf_calloc(1, sizeof(struct yf_compile_exec_job));
     ljob->job.type = YF_COMPILATION_EXEC;
+    ljob->phase = YF_PHASE_LINK;
+    ljob->unit = NULL;
     ljob->command = link_cmd;
-
+    ljob->output = link_cmd[num_objs + 2];
+    ljob->inputs = link_cmd + 1;
+    ljob->num_inputs = num_objs;
+
+    /* Every command so far produces one of the objects. */
+    struct yf_list_cursor jobs_cur;
+    YF_LIST_FOREACH_CUR(jobs_cur, compilation->jobs, job) {
+        if (job->type == YF_COMPILATION_EXEC)
+            yf_job_add_dep(&ljob->job, job);
+    }
     yf_list_add(&compilation->jobs, ljob);
 
     return 0;
 
 }
 
+void yf_backend_drop_dead_units(struct yf_compilation_data * compilation) {
+
+    struct yf_list_cursor jobs;
+    struct yf_compilation_job * job;
+    struct yf_compile_analyse_job * adata;
+    struct yf_compile_exec_job * exec, * link = NULL;
+    struct yfh_cursor cursor;
+    struct yf_sym * sym;
+    struct yf_hashmap unused;
+    size_t i, kept = 0;
+
+    YF_LIST_FOREACH_CUR(jobs, compilation->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        adata = (struct yf_compile_analyse_job *) job;
+        adata->dead = true;
+        if (!adata->symtab.table.buckets)
+            continue;
+        for (yfh_cursor_init(&cursor, &adata->symtab.table);
+            !yfh_cursor_next(&cursor); ) {
+            yfh_cursor_get(&cursor, NULL, (void **) &sym);
+            if (sym->reachable)
+                adata->dead = false;
+        }
+    }
+
+    /* The objects that won't be made, by name. */
+    yfh_init(&unused);
+    if (!unused.buckets)
+        return;
+    YF_LIST_FOREACH_CUR(jobs, compilation->jobs, job) {
+        if (job->type != YF_COMPILATION_EXEC)
+            continue;
+        exec = (struct yf_compile_exec_job *) job;
+        if (exec->phase == YF_PHASE_LINK)
+            link = exec;
+        else if (exec->unit && exec->unit->dead
+            && !yfh_set(&unused, exec->output, exec))
+            exec->skip = true;
+    }
+
+    /* Take them out of the link command - what follows the objects moves
+    up, its terminating NULL included. */
+    if (link) {
+        for (i = 0; i < link->num_inputs; ++i) {
+            if (yfh_get(&unused, link->inputs[i], (void **) &exec))
+                link->inputs[kept++] = link->inputs[i];
+        }
+        i = link->num_inputs;
+        do {
+            link->inputs[kept + i - link->num_inputs] = link->inputs[i];
+        } while (link->inputs[i++]);
+        link->num_inputs = kept;
+    }
+
+    yfh_destroy(&unused, NULL);
+
+}
+
 /**
  * Turn path.to.foo into path$to$foo for code generation.
  * y_prefix - the buf with path.to.foo
@@ -251,59 +797,183 @@ static int create_formatted_prefix(
 ) {
 
     int i;
-    for (i = 0; c_prefix[i]; ++i) {
+
+    /* Outside of a project, there is no prefix. */
+    if (!y_prefix)
+        y_prefix = "";
+
+    for (i = 0; y_prefix[i]; ++i) {
+        if (i == cplen - 1) {
+            /* We've been cut off */
+            c_prefix[i] = '\0';
+            return 1;
+        }
         if (y_prefix[i] == '.') {
             c_prefix[i] = '$';
         } else {
             c_prefix[i] = y_prefix[i];
         }
-        if (i == cplen) {
-            /* We've been cut off */
-            return 1;
-        }
     }
+    c_prefix[i] = '\0';
 
     return 0;
 
 }
 
-int yf_ensure_entry_point(
-    struct yf_compilation_data * pdata
+int yf_backend_set_up_pgo(
+    struct yf_compilation_data * compilation,
+    struct yf_args * args
 ) {
 
-    /* Iteration data */
-    struct yfs_symtab * fsymtab;
-    int total_entries = 0;
-    void * dummy;
+    char cwd[1024], * dir, * p;
+    const char * arg_dir;
+    size_t cwd_len, dir_len;
+    int64_t mtime;
 
-    struct yfh_cursor cursor;
-    for (yfh_cursor_init(&cursor, &pdata->symtables); !yfh_cursor_next(&cursor); ) {
+    compilation->pgo_dir_flag = NULL;
+    compilation->pgo_prefix = NULL;
 
-        yfh_cursor_get(&cursor, NULL, (void **)&fsymtab);
+    if (args->pgo == YF_PGO_NONE)
+        return 0;
 
-        /* If a lookup for "main" succeeds, that's another entry point. */
-        if (yfh_get(&fsymtab->table, "main", &dummy) == 0) {
-            ++total_entries;
+    if (!getcwd(cwd, sizeof cwd)) {
+        YF_PRINT_ERROR("Couldn't set up PGO: path name is too long");
+        return 1;
+    }
+    cwd_len = strlen(cwd);
+
+    /* The program writes its profile from wherever it's run, so the
+    directory is given to the C compiler as an absolute path. */
+    arg_dir = args->pgo_dir ? args->pgo_dir
+        : args->project ? "bin/pgo" : "yfc-pgo";
+    /* Room for <cwd>/<dir>/ */
+    dir_len = sizeof "-fprofile-dir=" + cwd_len + strlen(arg_dir) + 2;
+    if (!(compilation->pgo_dir_flag = yf_malloc(dir_len)))
+        return 3;
+    if (arg_dir[0] == '/') {
+        snprintf(compilation->pgo_dir_flag, dir_len,
+            "-fprofile-dir=%s/", arg_dir);
+    } else {
+        snprintf(compilation->pgo_dir_flag, dir_len,
+            "-fprofile-dir=%s/%s/", cwd, arg_dir);
+    }
+    dir = compilation->pgo_dir_flag + strlen("-fprofile-dir=");
+
+    /* The trailing slash makes sure the directory itself is created - it's
+    dropped again after. */
+    if (args->pgo == YF_PGO_GENERATE)
+        create_all_parent_dirs(dir);
+    dir[strlen(dir) - 1] = '\0';
+
+    if (args->pgo == YF_PGO_USE) {
+        if (file_info(dir, NULL, &mtime))
+            YF_PRINT_WARNING("No profile found in %s", dir);
+        dir_len = strlen(dir);
+        compilation->pgo_prefix = yf_malloc(dir_len + cwd_len + 3);
+        if (!compilation->pgo_prefix)
+            return 3;
+        memcpy(compilation->pgo_prefix, dir, dir_len);
+        compilation->pgo_prefix[dir_len] = '/';
+        memcpy(compilation->pgo_prefix + dir_len + 1, cwd, cwd_len);
+        memcpy(compilation->pgo_prefix + dir_len + 1 + cwd_len, "#", 2);
+        for (p = compilation->pgo_prefix + dir_len + 1; *p; ++p) {
+            if (*p == '/')
+                *p = '#';
         }
-
     }
 
+    return 0;
+
+}
+
+int yf_ensure_entry_point(
+    struct yf_compilation_data * pdata
+) {
+
+    /* The symbol index counts the "main" functions as it's built. */
+    unsigned total_entries = pdata->symindex.num_entry_points;
+
     if (total_entries != 1)
-        YF_PRINT_ERROR("total 'main' functions found: %d\n", total_entries);
+        YF_PRINT_ERROR("total 'main' functions found: %u", total_entries);
 
     return total_entries != 1;
 
 }
 
 int yf_backend_generate_code(
-    struct yf_compile_analyse_job * data
+    struct yf_compilation_data * pdata,
+    struct yf_compile_compile_job * cjob
 ) {
+    struct yf_compile_analyse_job * data = cjob->unit;
     struct yf_gen_info ginfo = {
         .yf_prefix = data->unit_info->file_prefix,
         .tab_depth = 0,
+        .instrument = pdata->instrument,
     };
     create_formatted_prefix(
         ginfo.yf_prefix, ginfo.gen_prefix, 256
     );
-    return yf_gen_c(data, &ginfo);
+    if (cjob->in_memory) {
+        /* The object still goes where the C file would have. */
+        create_all_parent_dirs(data->unit_info->output_file);
+        if (yfg_gen(data, &ginfo, &cjob->code)) {
+            YF_PRINT_ERROR("could not generate code for %s",
+                data->unit_info->file_name);
+            return 3;
+        }
+        return 0;
+    }
+    return yf_gen_c(pdata->build_db, data, &ginfo);
+}
+
+int yf_backend_generate_unity(
+    struct yf_compilation_data * pdata,
+    struct yf_compile_unity_job * shard
+) {
+
+    struct yf_compilation_job * job;
+    struct yf_compile_compile_job * cjob;
+    struct yf_gen_info ginfo;
+    struct yf_strbuf * code = &shard->code;
+    int failed = 0, retval;
+
+    yf_strbuf_init(code);
+    memset(&ginfo, 0, sizeof ginfo);
+    ginfo.instrument = pdata->instrument;
+    yfg_gen_header(code, &ginfo);
+
+    /* Declare the globals of every unit first - units in other files
+    included - so that no unit has to come before the ones it uses. */
+    memset(&ginfo, 0, sizeof ginfo);
+    YF_LIST_FOREACH(pdata->jobs, job) {
+        if (job->type == YF_COMPILATION_ANALYSE) {
+            failed |= yfg_gen_decls(
+                &((struct yf_compile_analyse_job *) job)->symtab, &ginfo, code
+            );
+        }
+    }
+    yf_strbuf_putc(code, '\n');
+
+    YF_VEC_FOREACH(shard->units, cjob) {
+        memset(&ginfo, 0, sizeof ginfo);
+        ginfo.instrument = pdata->instrument;
+        ginfo.yf_prefix = cjob->unit->unit_info->file_prefix;
+        create_formatted_prefix(ginfo.yf_prefix, ginfo.gen_prefix, 256);
+        failed |= yfg_gen_unit(cjob->unit, &ginfo, code);
+    }
+
+    if (failed) {
+        YF_PRINT_ERROR("could not generate code for %s", shard->output_file);
+        yf_strbuf_destroy(code);
+        return 3;
+    }
+
+    create_all_parent_dirs(shard->output_file);
+    if (shard->in_memory)
+        return 0;
+
+    retval = yf_write_c_file(pdata->build_db, shard->output_file, code);
+    yf_strbuf_destroy(code);
+    return retval;
+
 }
@@ -7,13 +7,51 @@
 
 #include <api/compilation-data.h>
 #include <driver/args.h>
+#include <driver/os.h>
 
 void yf_print_command(
     struct yf_compile_exec_job *
 );
 
-int yf_exec_command(
-    struct yf_compile_exec_job *
+/**
+ * Check whether a command's output is up to date, so it doesn't need to run:
+ * the build database must say it was made by the same command, from inputs
+ * with the same contents. Without a database, nothing is up to date.
+ */
+bool yf_command_up_to_date(
+    struct yf_compilation_data *, struct yf_compile_exec_job *
+);
+
+/**
+ * Start the command of a job, without waiting for it. If it reads its standard
+ * input from the job, what fits in the pipe is written right away, and the
+ * rest is left to yf_feed_command.
+ */
+int yf_start_command(
+    struct yf_compilation_data *, struct yf_compile_exec_job *,
+    process_handle *
+);
+
+/**
+ * Write what the pipe to a running command's standard input takes without
+ * waiting, and close it once all of the input is written. If it can't be
+ * written, the command is killed. Does nothing once the input is all written.
+ */
+void yf_feed_command(struct yf_compile_exec_job *, process_handle *);
+
+/**
+ * Close the pipe to a command's standard input, and free what wasn't written
+ * to it - when the command has exited, or is being killed.
+ */
+void yf_drop_command_input(struct yf_compile_exec_job *);
+
+/**
+ * Record how a command went, once its process has been waited for. Returns
+ * nonzero if it failed.
+ */
+int yf_finish_command(
+    struct yf_compilation_data *, struct yf_compile_exec_job *,
+    process_handle *
 );
 
 int yf_backend_find_compiler(
@@ -24,7 +62,18 @@ int yf_backend_find_compiler(
 char * yf_backend_add_compile_job(
     struct yf_compilation_data *,
     struct yf_args *,
-    struct yf_compilation_unit_info *
+    struct yf_compile_compile_job *
+);
+
+/**
+ * Add the C compiler job of a --unity file, and name the file - the index
+ * tells it apart from the others. Returns the name of the output object file.
+ */
+char * yf_backend_add_unity_job(
+    struct yf_compilation_data *,
+    struct yf_args *,
+    struct yf_compile_unity_job *,
+    int index
 );
 
 int yf_backend_add_link_job(
@@ -33,12 +82,42 @@ int yf_backend_add_link_job(
     struct yf_list * object_list
 );
 
+/**
+ * Once the reachable globals are known, find the units with none, and don't
+ * compile or link their objects.
+ */
+void yf_backend_drop_dead_units(struct yf_compilation_data *);
+
+/**
+ * Write the C code of a unit, unless what's already there is the same - or
+ * with --no-c-files, keep it in the job for the C compiler.
+ */
 int yf_backend_generate_code(
-    struct yf_compile_analyse_job *
+    struct yf_compilation_data *,
+    struct yf_compile_compile_job *
+);
+
+/**
+ * Generate the code of all units of a --unity file, which must have been
+ * validated, and write it like yf_backend_generate_code.
+ */
+int yf_backend_generate_unity(
+    struct yf_compilation_data *,
+    struct yf_compile_unity_job *
+);
+
+/**
+ * With --pgo-generate or --pgo-use, find the profile directory, and create it
+ * if the program is to write to it. Must be called before any jobs are added.
+ */
+int yf_backend_set_up_pgo(
+    struct yf_compilation_data *,
+    struct yf_args *
 );
 
 /**
  * Make sure that there is exactly one "main" function. Returns 0 on success.
+ * Must only be called after the symbol index is built.
  */
 int yf_ensure_entry_point(
     struct yf_compilation_data *
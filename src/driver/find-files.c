@@ -242,6 +242,7 @@ int yfd_get_identifier_prefix(
         prefix++;
         file_name++;
     }
+    *prefix = '\0';
 
     /**
      * Remove trailing .yf
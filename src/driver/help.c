@@ -9,15 +9,27 @@ const char
       "-v, --version: Display version.\n"
       "--native-compiler <compiler>: specify the native C compiler to use.\n"
       "--compiler-type gcc|msvc: specify the flavor of the native C compiler. (default: gcc)\n"
+      "-j <n>, --jobs=<n>: Run up to n C compiler processes at once. (default: one per processor)\n"
       "--project: Compile project. Read documentation for more specifics on this flag.\n"
       "--dump-tokens: Print out all tokens and exit.\n"
       "--dump-cst: Print out the CST and exit.\n"
       "--just-semantics: Only verify the program, do not run generation.\n"
       "--just-gen: Generate the code but don't compile the C.\n"
-      "--benchmark: Print out time taken for each step.\n"
+      "--unity[=<n>]: Generate n C files for the whole program, instead of one per file. (default: 1)\n"
+      "--no-c-files: Pipe the generated code straight into the C compiler, without writing C files.\n"
+      "-O0, -O1, -O2, -O3, -Os: Optimization level for the C compiler.\n"
+      "--lto: Optimize across files when linking.\n"
+      "--cflags=<flags>: Extra flags for the C compiler, separated by spaces.\n"
+      "--ldflags=<flags>: Extra flags for the linker, separated by spaces.\n"
+      "--pgo-generate[=<dir>]: Build a program that writes a profile to dir when run. (default: bin/pgo)\n"
+      "--pgo-use[=<dir>]: Optimize with the profile in dir, written by a --pgo-generate build. (default: bin/pgo)\n"
+      "--instrument: Make the program count the calls and time of each function, and write them to yf-instrument.txt on exit.\n"
+      "--profile, --benchmark: Print out time taken for each step.\n"
+      "--mem-report: Print out memory allocated by each part of the compiler, and the peak memory used.\n"
       "--dump-projfiles: Print out all files in a project.\n"
       "--dump-commands: Print all compiler invocations.\n"
       "--simulate-run: Like --dump-commands, print all compiler invocations, but don't actually do anything.\n"
+      "--trace-out=<file>: Write a timeline of all jobs to a file, in trace event format (for chrome://tracing or Perfetto).\n"
       ,
     * HELP_HINT_MSG = "Invalid command. "
       "Use \"-h\" or \"--help\" for a list of possible commands.\n",
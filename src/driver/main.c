@@ -4,10 +4,12 @@
 
 #include <driver/args.h>
 #include <driver/compile.h>
+#include <driver/os.h>
 
 int main(int argc, char ** argv) {
     
     struct yf_args args;
+    proc_init();
     yf_parse_args(argc, argv, &args);
 
     if (yf_should_compile(&args)) {
@@ -21,8 +21,13 @@ int proc_exec(const char * const argv[], const file_open_descriptor descs[], int
 #if defined(YF_PLATFORM_UNIX)
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 
 int proc_open(process_handle * proc, const char * const argv[], const file_open_descriptor descs[], int flags) {
     pid_t child_pid = fork();
@@ -36,6 +41,10 @@ int proc_open(process_handle * proc, const char * const argv[], const file_open_
         for (const file_open_descriptor * descriptor = descs; descriptor->target_fd != -1; ++descriptor) {
             if (descriptor->target_fd > maxfd)
                 maxfd = descriptor->target_fd;
+            /* /dev/null is moved above every fd in use, sources included -
+            otherwise it could land on one that's about to be passed on. */
+            if (descriptor->source_fd > maxfd)
+                maxfd = descriptor->source_fd;
         }
         for (const file_open_descriptor * descriptor = descs; descriptor->target_fd != -1; ++descriptor) {
             if (descriptor->target_fd >= (int)descriptors_sz) {
@@ -82,17 +91,132 @@ int proc_open(process_handle * proc, const char * const argv[], const file_open_
     return 0;
 }
 
+static void proc_save_status(
+    process_handle * proc, int status, const struct rusage * usage
+) {
+    /* A process killed by a signal has failed too, like in the shell. */
+    proc->exit_code = WIFEXITED(status)
+        ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    proc->user_us = usage->ru_utime.tv_sec * 1000000L + usage->ru_utime.tv_usec;
+    proc->sys_us = usage->ru_stime.tv_sec * 1000000L + usage->ru_stime.tv_usec;
+    proc->maxrss_kb = usage->ru_maxrss;
+}
+
 int proc_wait(process_handle * proc) {
     int status;
-    if (waitpid(proc->pid, &status, 0) == -1) {
+    struct rusage usage;
+    if (wait4(proc->pid, &status, 0, &usage) == -1) {
         perror("Warning: wait failed");
         return -2;
     }
-    proc->exit_code = WEXITSTATUS(status);
+    proc_save_status(proc, status, &usage);
     return 0;
 }
+
+int proc_wait_any(process_handle * const procs[], size_t num_procs, bool block) {
+    int status;
+    struct rusage usage;
+    pid_t pid;
+    size_t i;
+    for (;;) {
+        pid = wait4(-1, &status, block ? 0 : WNOHANG, &usage);
+        if (pid == 0)
+            return -1;
+        if (pid == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("Warning: wait failed");
+            return -2;
+        }
+        for (i = 0; i < num_procs; ++i) {
+            if (procs[i]->pid == pid) {
+                proc_save_status(procs[i], status, &usage);
+                return (int) i;
+            }
+        }
+        /* Not one of ours - keep waiting. */
+    }
+}
+
+int proc_kill(process_handle * proc) {
+    return kill(proc->pid, SIGTERM);
+}
+
+int proc_count_cpus(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int) count : 1;
+}
+
+void proc_init(void) {
+    signal(SIGPIPE, SIG_IGN);
+}
+
+int pipe_open(int fds[2]) {
+    if (pipe(fds) == -1)
+        return 1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    return 0;
+}
+
+long fd_write_some(int fd, const void * data, size_t len) {
+    ssize_t written;
+    do {
+        written = write(fd, data, len);
+    } while (written == -1 && errno == EINTR);
+    if (written == -1)
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    return (long) written;
+}
+
+int fd_wait_writable(const int fds[], size_t num_fds, int timeout_ms) {
+    struct pollfd polls[64];
+    size_t i;
+    if (num_fds > sizeof polls / sizeof polls[0])
+        num_fds = sizeof polls / sizeof polls[0];
+    for (i = 0; i < num_fds; ++i) {
+        polls[i].fd = fds[i];
+        polls[i].events = POLLOUT;
+        polls[i].revents = 0;
+    }
+    return poll(polls, num_fds, timeout_ms) == -1 && errno != EINTR;
+}
+
+void fd_close(int fd) {
+    close(fd);
+}
+
+int file_info(const char * path, int64_t * size, int64_t * mtime_ns) {
+    struct stat st;
+    if (stat(path, &st) == -1)
+        return 1;
+    if (size)
+        *size = st.st_size;
+#if YF_SUBPLATFORM == YF_PLATFORMID_APPLE
+    *mtime_ns = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    *mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    return 0;
+}
+
+int file_replace(const char * from, const char * to) {
+    return rename(from, to) != 0;
+}
+
+long proc_peak_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == -1)
+        return 0;
+    return usage.ru_maxrss;
+}
 #elif defined(YF_PLATFORM_WINNT)
 #include <Windows.h>
+#include <Psapi.h>
+#include <fcntl.h>
+#include <io.h>
+#include <limits.h>
 
 // Adapted from https://stackoverflow.com/questions/2611044/process-start-pass-html-code-to-exe-as-argument/2611075#2611075
 static void EscapeBackslashes(char ** sb, char const* s, char const* begin)
@@ -178,8 +302,9 @@ int proc_open(process_handle * proc, const char * const argv[], const file_open_
                 handle = GetStdHandle(STD_ERROR_HANDLE);
                 break;
             default:
-                fputs("Warning: Windows process exec source fd > 2\n", stderr);
-                return -1;
+                /* Like the read end of a pipe. */
+                handle = (HANDLE) _get_osfhandle(descriptor->source_fd);
+                break;
         }
         handles[descriptor->target_fd] = handle;
     }
@@ -217,6 +342,101 @@ int proc_wait(process_handle * proc) {
 
     return 0;
 }
+
+int proc_wait_any(process_handle * const procs[], size_t num_procs, bool block) {
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    DWORD res;
+    size_t i;
+    if (num_procs > MAXIMUM_WAIT_OBJECTS)
+        return -2;
+    for (i = 0; i < num_procs; ++i)
+        handles[i] = (HANDLE) procs[i]->pid;
+    res = WaitForMultipleObjects(
+        (DWORD) num_procs, handles, FALSE, block ? INFINITE : 0
+    );
+    if (res == WAIT_TIMEOUT)
+        return -1;
+    if (res >= WAIT_OBJECT_0 + num_procs)
+        return -2;
+    i = res - WAIT_OBJECT_0;
+    procs[i]->exit_code = -2;
+    GetExitCodeProcess(handles[i], (DWORD *) &procs[i]->exit_code);
+    CloseHandle(handles[i]);
+    return (int) i;
+}
+
+int proc_kill(process_handle * proc) {
+    return !TerminateProcess((HANDLE) proc->pid, 1);
+}
+
+int proc_count_cpus(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int) info.dwNumberOfProcessors : 1;
+}
+
+void proc_init(void) {
+    /* Writing to a pipe without a reader already just fails. */
+}
+
+int pipe_open(int fds[2]) {
+    return _pipe(fds, 65536, _O_BINARY | _O_NOINHERIT) != 0;
+}
+
+long fd_write_some(int fd, const void * data, size_t len) {
+    /* Anonymous pipes can't be written without waiting, so this writes it
+    all - the C compiler still reads all of its input first. */
+    const char * p = data;
+    int written;
+    while (len) {
+        written = _write(fd, p, len > INT_MAX ? INT_MAX : (unsigned) len);
+        if (written <= 0)
+            return -1;
+        p += written;
+        len -= written;
+    }
+    return (long) (p - (const char *) data);
+}
+
+int fd_wait_writable(const int fds[], size_t num_fds, int timeout_ms) {
+    (void) fds;
+    (void) num_fds;
+    (void) timeout_ms;
+    return 0;
+}
+
+void fd_close(int fd) {
+    _close(fd);
+}
+
+int file_info(const char * path, int64_t * size, int64_t * mtime_ns) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    ULARGE_INTEGER time;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+        return 1;
+    if (size)
+        *size = ((int64_t) data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+    time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+    /* In 100 ns ticks since 1601 */
+    *mtime_ns = (int64_t) (time.QuadPart - 116444736000000000ULL) * 100;
+    return 0;
+}
+
+int file_replace(const char * from, const char * to) {
+    /* Unlike POSIX, rename() won't replace an existing file here. */
+    return !MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+}
+
+long proc_peak_rss_kb(void) {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(
+        GetCurrentProcess(), &counters, sizeof counters
+    ))
+        return 0;
+    /* The peak working set is the closest thing to the peak RSS. */
+    return (long) (counters.PeakWorkingSetSize / 1024);
+}
 #else /* YF_PLATFORM_UNIX | YF_PLATFORM_WINNT */
 #error Unknown platform
 #endif
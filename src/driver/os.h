@@ -8,6 +8,8 @@
 
 #define YF_OS_USE_PATH (1 << 0)
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
@@ -18,6 +20,8 @@ typedef struct {
 typedef struct {
     intptr_t pid;
     int exit_code;
+    /* Resources used by the process, filled in by proc_wait. Left at zero where the platform doesn't report them. */
+    long user_us, sys_us, maxrss_kb;
 } process_handle;
 
 /**
@@ -35,9 +39,89 @@ int proc_exec(const char * const argv[], const file_open_descriptor descs[], int
 int proc_open(process_handle * proc, const char * const argv[], const file_open_descriptor descs[], int flags);
 
 /**
- * Waits for a process and saves the exit code
+ * Waits for a process and saves the exit code and resource usage
  * @return 0 on success, otherwise nonzero
  */
 int proc_wait(process_handle * proc);
 
+/**
+ * Waits for any one of the given processes to exit, and saves its exit code
+ * and resource usage like proc_wait. If block is false, returns right away
+ * when none has exited yet.
+ * @return the index of the process that exited, -1 if none has (and block is
+ * false), or -2 on error
+ */
+int proc_wait_any(process_handle * const procs[], size_t num_procs, bool block);
+
+/**
+ * Kills a process. It still has to be waited for afterwards.
+ * @return 0 on success, otherwise nonzero
+ */
+int proc_kill(process_handle * proc);
+
+/**
+ * How many processors this machine has - at least 1.
+ */
+int proc_count_cpus(void);
+
+/**
+ * Set up the process to run commands - call once, before any other of these.
+ * On Unix, writing to a pipe whose reader has exited then fails, rather than
+ * killing us with SIGPIPE.
+ */
+void proc_init(void);
+
+/**
+ * Open a pipe - fds[0] is the end to read from, fds[1] the end to write to.
+ * Neither end is inherited by child processes, unless it's passed to one
+ * through a file_open_descriptor; otherwise, a reader would never see the end
+ * of its input while another child still held the write end.
+ * Where the platform allows it, writing never waits for the reader - see
+ * fd_write_some.
+ * @return 0 on success, or nonzero on failure
+ */
+int pipe_open(int fds[2]);
+
+/**
+ * Write as much of a buffer to the write end of a pipe as it takes without
+ * waiting. Where pipes can't be written without waiting (Windows), all of it
+ * is written.
+ * @return how many bytes were written - 0 if the pipe is full - or -1 on
+ * failure, like when the reader has exited
+ */
+long fd_write_some(int fd, const void * data, size_t len);
+
+/**
+ * Wait until one of the pipes can be written to, or its reader has exited, or
+ * until timeout_ms have passed. Returns right away where writes never have to
+ * wait.
+ * @return 0 on success, or nonzero on failure
+ */
+int fd_wait_writable(const int fds[], size_t num_fds, int timeout_ms);
+
+/**
+ * Close a file descriptor, like one end of a pipe.
+ */
+void fd_close(int fd);
+
+/**
+ * Gets the size of a file, and when it was last modified, in nanoseconds since
+ * the epoch - as precise as the platform allows. The size may be NULL.
+ * @return 0 on success, or nonzero if the file can't be found
+ */
+int file_info(const char * path, int64_t * size, int64_t * mtime_ns);
+
+/**
+ * Move a file over another one, replacing it in a single step - so that anyone
+ * reading the destination sees either the old file or the new one.
+ * @return 0 on success, or nonzero if it couldn't be moved
+ */
+int file_replace(const char * from, const char * to);
+
+/**
+ * The most memory this process has had resident at once, in KiB - or 0 if the
+ * platform doesn't tell us.
+ */
+long proc_peak_rss_kb(void);
+
 #endif /* DRIVER_OS_H */
@@ -0,0 +1,336 @@
+#include "scheduler.h"
+
+#include <string.h>
+
+#include <driver/compiler-backend.h>
+#include <driver/os.h>
+#include <util/allocator.h>
+#include <util/profile.h>
+#include <util/yfc-out.h>
+
+/* Windows can't wait for more processes than this at once. */
+#define YF_MAX_SLOTS 64
+
+/* While writing to a command's input, how long to wait for the pipe before
+checking whether other commands have finished, in milliseconds. */
+#define YF_FEED_WAIT_MS 10
+
+/**
+ * Ready jobs, in the order they became ready.
+ */
+struct yf_job_queue {
+    struct yf_vec jobs;
+    size_t head;
+};
+
+/**
+ * A command that's running. The slot is free if the job is NULL.
+ */
+struct yf_job_slot {
+    struct yf_compile_exec_job * job;
+    process_handle proc;
+};
+
+struct yf_scheduler {
+
+    struct yf_compilation_data * data;
+    struct yf_args * args;
+    yf_job_runner run;
+
+    /* Jobs we do ourselves, and commands. */
+    struct yf_job_queue frontend, commands;
+
+    struct yf_job_slot slots[YF_MAX_SLOTS];
+    int num_slots, running;
+
+    /* How many jobs haven't finished yet. */
+    size_t left;
+
+};
+
+int yf_job_add_dep(
+    struct yf_compilation_job * job, struct yf_compilation_job * dep
+) {
+    if (yf_vec_add(&dep->dependents, job))
+        return 3;
+    ++job->waiting_for;
+    return 0;
+}
+
+static bool yf_queue_empty(struct yf_job_queue * queue) {
+    return queue->head == yf_vec_count(&queue->jobs);
+}
+
+static struct yf_compilation_job * yf_queue_pop(struct yf_job_queue * queue) {
+    return yf_vec_get(&queue->jobs, queue->head++);
+}
+
+static int yf_job_ready(
+    struct yf_scheduler * s, struct yf_compilation_job * job
+) {
+    struct yf_job_queue * queue =
+        job->type == YF_COMPILATION_EXEC ? &s->commands : &s->frontend;
+    return yf_vec_add(&queue->jobs, job) ? 3 : 0;
+}
+
+/**
+ * Mark a job as done, which may make the jobs waiting for it ready.
+ */
+static int yf_job_done(
+    struct yf_scheduler * s, struct yf_compilation_job * job
+) {
+
+    struct yf_compilation_job * dependent;
+
+    --s->left;
+    YF_VEC_FOREACH(job->dependents, dependent) {
+        if (--dependent->waiting_for == 0 && yf_job_ready(s, dependent))
+            return 3;
+    }
+
+    return 0;
+
+}
+
+static int yf_run_frontend_job(
+    struct yf_scheduler * s, struct yf_compilation_job * job
+) {
+
+    int res;
+
+    if (!s->args->simulate_run) {
+        job->start_ns = yf_profile_now();
+        job->track = 0;
+    }
+    res = s->run(s->data, s->args, job);
+    if (!s->args->simulate_run)
+        job->end_ns = yf_profile_now();
+
+    return res ? res : yf_job_done(s, job);
+
+}
+
+/**
+ * Start a command in a free slot. When simulating, it's done right away.
+ */
+static int yf_launch(
+    struct yf_scheduler * s, struct yf_compile_exec_job * job
+) {
+
+    int slot;
+
+    job->cached = !job->skip && yf_command_up_to_date(s->data, job);
+
+    if (s->args->dump_commands)
+        yf_print_command(job);
+
+    if (job->skip || job->cached || s->args->simulate_run)
+        return yf_job_done(s, &job->job);
+
+    for (slot = 0; s->slots[slot].job; ++slot)
+        ;
+
+    job->job.start_ns = yf_profile_now();
+    job->job.track = slot + 1;
+    if (yf_start_command(s->data, job, &s->slots[slot].proc))
+        return 2;
+
+    s->slots[slot].job = job;
+    ++s->running;
+    return 0;
+
+}
+
+/**
+ * Reap one command that has finished, if any has, and see how it went. Only
+ * waits for one to finish if block is set.
+ */
+static int yf_reap(struct yf_scheduler * s, bool block, bool * reaped) {
+
+    process_handle * procs[YF_MAX_SLOTS];
+    int slots[YF_MAX_SLOTS];
+    int slot, count = 0, which;
+    struct yf_compile_exec_job * job;
+
+    *reaped = false;
+
+    for (slot = 0; slot < s->num_slots; ++slot) {
+        if (s->slots[slot].job) {
+            procs[count] = &s->slots[slot].proc;
+            slots[count++] = slot;
+        }
+    }
+
+    if (count == 0)
+        return 0;
+
+    which = proc_wait_any(procs, count, block);
+    if (which == -1)
+        return 0;
+    if (which < 0)
+        return 2;
+
+    *reaped = true;
+    slot = slots[which];
+    job = s->slots[slot].job;
+    job->job.end_ns = yf_profile_now();
+    s->slots[slot].job = NULL;
+    --s->running;
+
+    if (yf_finish_command(s->data, job, &s->slots[slot].proc))
+        return 2;
+
+    return yf_job_done(s, &job->job);
+
+}
+
+/**
+ * Reap every command that has finished by now.
+ */
+static int yf_reap_finished(struct yf_scheduler * s) {
+
+    bool reaped;
+    int res;
+
+    do {
+        res = yf_reap(s, false, &reaped);
+    } while (!res && reaped);
+
+    return res;
+
+}
+
+/**
+ * Write more of the input of every command that's still reading it. Fills in
+ * the pipes that are still being written to, and returns how many there are.
+ */
+static size_t yf_feed_commands(struct yf_scheduler * s, int fds[]) {
+
+    int slot;
+    size_t count = 0;
+    struct yf_job_slot * running;
+
+    for (slot = 0; slot < s->num_slots; ++slot) {
+        running = &s->slots[slot];
+        if (!running->job || !running->job->stdin_data)
+            continue;
+        yf_feed_command(running->job, &running->proc);
+        if (running->job->stdin_data && running->job->stdin_fd >= 0)
+            fds[count++] = running->job->stdin_fd;
+    }
+
+    return count;
+
+}
+
+/**
+ * Stop all commands that are still running, after something failed.
+ */
+static void yf_kill_all(struct yf_scheduler * s) {
+
+    int slot;
+    struct yf_job_slot * running;
+
+    for (slot = 0; slot < s->num_slots; ++slot) {
+        running = &s->slots[slot];
+        if (!running->job)
+            continue;
+        proc_kill(&running->proc);
+        yf_drop_command_input(running->job);
+        proc_wait(&running->proc);
+        running->job->job.end_ns = yf_profile_now();
+        running->job->exit_code = running->proc.exit_code;
+        running->job = NULL;
+    }
+
+    s->running = 0;
+
+}
+
+int yf_run_jobs(
+    struct yf_compilation_data * data,
+    struct yf_args * args,
+    yf_job_runner run
+) {
+
+    struct yf_scheduler s;
+    struct yf_compilation_job * job;
+    int res = 0, budget;
+    int feeding[YF_MAX_SLOTS];
+    size_t num_feeding;
+
+    memset(&s, 0, sizeof s);
+    s.data = data;
+    s.args = args;
+    s.run = run;
+    s.num_slots = args->jobs ? args->jobs : proc_count_cpus();
+    if (s.num_slots > YF_MAX_SLOTS)
+        s.num_slots = YF_MAX_SLOTS;
+
+    /* Jobs were added in an order that works when run one by one, so keep
+    that order among the jobs that are ready from the start. */
+    YF_LIST_FOREACH(data->jobs, job) {
+        ++s.left;
+        if (job->waiting_for == 0 && (res = yf_job_ready(&s, job)))
+            goto out;
+    }
+
+    while (s.left) {
+
+        if ((res = yf_reap_finished(&s)))
+            break;
+
+        /* Start commands before doing our own work, so that they run while
+        we do it. The compiler counts as one of the slots while it has work
+        left, so that we never run more than -j at once. */
+        budget = s.num_slots - !yf_queue_empty(&s.frontend);
+        while (s.running < budget && !yf_queue_empty(&s.commands)) {
+            job = yf_queue_pop(&s.commands);
+            if ((res = yf_launch(&s, (struct yf_compile_exec_job *) job)))
+                break;
+        }
+        if (res)
+            break;
+
+        /* The C compiler reads all of its input before compiling, so code
+        piped to it is written a pipe-full at a time, in between our own
+        jobs, rather than all at once while nothing else is scheduled. */
+        num_feeding = yf_feed_commands(&s, feeding);
+
+        if (!yf_queue_empty(&s.frontend)) {
+            if ((res = yf_run_frontend_job(&s, yf_queue_pop(&s.frontend))))
+                break;
+            continue;
+        }
+
+        if (num_feeding) {
+            /* Waiting for a command to exit could wait forever, if it's
+            waiting for its input. */
+            if (fd_wait_writable(feeding, num_feeding, YF_FEED_WAIT_MS)) {
+                YF_PRINT_ERROR("Could not wait for the C compiler's input");
+                res = 2;
+                break;
+            }
+        } else if (s.running) {
+            bool reaped;
+            if ((res = yf_reap(&s, true, &reaped)))
+                break;
+        } else if (yf_queue_empty(&s.frontend)
+            && yf_queue_empty(&s.commands) && s.left) {
+            YF_PRINT_ERROR("Internal error: jobs are waiting for each other");
+            res = 2;
+            break;
+        }
+
+    }
+
+out:
+    if (res)
+        yf_kill_all(&s);
+
+    yf_vec_destroy(&s.frontend.jobs, 0);
+    yf_vec_destroy(&s.commands.jobs, 0);
+
+    return res;
+
+}
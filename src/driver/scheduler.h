@@ -0,0 +1,40 @@
+/**
+ * Runs the jobs of a build in dependency order. Each job lists the jobs that
+ * wait for it, and counts the jobs it waits for - once that count drops to
+ * zero, it's ready. Jobs done by the compiler itself run one at a time, on the
+ * calling thread, while commands run as child processes. Commands are started
+ * as soon as they're ready, so a unit's C compiler runs while the next unit is
+ * still being validated - the compiler takes up one of the -j slots while it
+ * has work of its own.
+ */
+
+#ifndef DRIVER_SCHEDULER_H
+#define DRIVER_SCHEDULER_H
+
+#include <api/compilation-data.h>
+#include <driver/args.h>
+
+/**
+ * Runs a job that isn't a command - those are started by the scheduler.
+ */
+typedef int (*yf_job_runner)(
+    struct yf_compilation_data *, struct yf_args *,
+    struct yf_compilation_job *
+);
+
+/**
+ * Make a job wait for another one. Returns 3 if we're out of memory.
+ */
+int yf_job_add_dep(
+    struct yf_compilation_job * job, struct yf_compilation_job * dep
+);
+
+/**
+ * Run all jobs. The first job to fail stops the build: no more jobs are
+ * started, any commands still running are killed, and its code is returned.
+ */
+int yf_run_jobs(
+    struct yf_compilation_data *, struct yf_args *, yf_job_runner
+);
+
+#endif /* DRIVER_SCHEDULER_H */
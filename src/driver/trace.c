@@ -0,0 +1,214 @@
+#include "trace.h"
+
+#include <stdio.h>
+
+#include <util/list.h>
+
+static const char * const yf_stage_names[] = {
+    [YF_COMPILE_LEXONLY]     = "lex",
+    [YF_COMPILE_PARSEONLY]   = "parse",
+    [YF_COMPILE_ANALYSEONLY] = "analyse",
+    [YF_COMPILE_CODEGENONLY] = "codegen",
+    [YF_COMPILE_FULL]        = "full",
+};
+
+/**
+ * Write a string escaped for JSON, without the surrounding quotes.
+ */
+static void yf_trace_escape(FILE * out, const char * str) {
+
+    for (; *str; ++str) {
+        switch (*str) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if ((unsigned char) *str < 0x20)
+                    fprintf(out, "\\u%04x", (unsigned char) *str);
+                else
+                    fputc(*str, out);
+        }
+    }
+
+}
+
+static void yf_trace_string(FILE * out, const char * str) {
+    fputc('"', out);
+    yf_trace_escape(out, str);
+    fputc('"', out);
+}
+
+/**
+ * Write the start of an event, up to and including the opening of its
+ * arguments. The detail, if any, is appended to the name - like the file a job
+ * works on.
+ */
+static void yf_trace_begin_event(
+    FILE * out, struct yf_compilation_job * job, uint64_t origin,
+    const char * name, const char * detail
+) {
+
+    fprintf(out, ",\n{\"name\":\"%s", name);
+    if (detail) {
+        fputc(' ', out);
+        yf_trace_escape(out, detail);
+    }
+
+    fprintf(out,
+        "\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+        job->track, (job->start_ns - origin) / 1e3,
+        (job->end_ns - job->start_ns) / 1e3
+    );
+
+}
+
+static void yf_trace_unit_args(
+    FILE * out, struct yf_compile_analyse_job * unit
+) {
+    fputs("\"unit\":", out);
+    yf_trace_string(out, unit->unit_info->file_name);
+    fprintf(out, ",\"stage\":\"%s\"", yf_stage_names[unit->stage]);
+}
+
+static void yf_trace_exec_args(FILE * out, struct yf_compile_exec_job * job) {
+
+    const char ** arg;
+
+    if (job->unit) {
+        yf_trace_unit_args(out, job->unit);
+        fputc(',', out);
+    }
+
+    fputs("\"command\":\"", out);
+    for (arg = job->command; *arg; ++arg) {
+        if (arg != job->command)
+            fputc(' ', out);
+        yf_trace_escape(out, *arg);
+    }
+    fputc('"', out);
+
+    fprintf(out,
+        ",\"exit_code\":%d,\"user_ms\":%.3f,\"sys_ms\":%.3f,"
+        "\"maxrss_kb\":%ld",
+        job->exit_code, job->user_us / 1e3, job->sys_us / 1e3, job->maxrss_kb
+    );
+
+}
+
+static void yf_trace_job(
+    FILE * out, struct yf_compilation_job * job, uint64_t origin
+) {
+
+    struct yf_compile_analyse_job * unit;
+    struct yf_compile_exec_job * exec;
+
+    switch (job->type) {
+
+        case YF_COMPILATION_ANALYSE:
+            unit = (struct yf_compile_analyse_job *) job;
+            yf_trace_begin_event(
+                out, job, origin, "analyse", unit->unit_info->file_name
+            );
+            yf_trace_unit_args(out, unit);
+            break;
+
+        case YF_COMPILATION_INDEX:
+            yf_trace_begin_event(out, job, origin, "index", NULL);
+            break;
+
+        case YF_COMPILATION_COMPILE:
+            unit = ((struct yf_compile_compile_job *) job)->unit;
+            yf_trace_begin_event(
+                out, job, origin, "compile", unit->unit_info->file_name
+            );
+            yf_trace_unit_args(out, unit);
+            break;
+
+        case YF_COMPILATION_UNITY:
+            yf_trace_begin_event(out, job, origin, "unity",
+                ((struct yf_compile_unity_job *) job)->output_file
+            );
+            break;
+
+        case YF_COMPILATION_EXEC:
+            exec = (struct yf_compile_exec_job *) job;
+            if (exec->phase == YF_PHASE_LINK) {
+                yf_trace_begin_event(out, job, origin, "link", NULL);
+            } else {
+                /* A --unity file is compiled for more than one unit. */
+                yf_trace_begin_event(out, job, origin, "cc",
+                    exec->unit ? exec->unit->unit_info->file_name
+                               : exec->output
+                );
+            }
+            yf_trace_exec_args(out, exec);
+            break;
+
+    }
+
+    fputs("}}", out);
+
+}
+
+/**
+ * Name the process and each track, so the viewer doesn't just show numbers.
+ */
+static void yf_trace_metadata(FILE * out, int max_track) {
+
+    int track;
+
+    fputs(
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+        "\"args\":{\"name\":\"yfc\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+        "\"args\":{\"name\":\"yfc\"}}",
+        out
+    );
+
+    for (track = 1; track <= max_track; ++track) {
+        fprintf(out,
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"process %d\"}}",
+            track, track
+        );
+    }
+
+}
+
+int yf_write_trace(const char * path, struct yf_compilation_data * data) {
+
+    FILE * out;
+    struct yf_compilation_job * job;
+    uint64_t origin = 0;
+    int max_track = 0;
+
+    /* Times are relative to the first job, and jobs that never ran are left
+    out entirely. */
+    YF_LIST_FOREACH(data->jobs, job) {
+        if (job->start_ns == 0)
+            continue;
+        if (origin == 0 || job->start_ns < origin)
+            origin = job->start_ns;
+        if (job->track > max_track)
+            max_track = job->track;
+    }
+
+    out = fopen(path, "w");
+    if (!out)
+        return 1;
+
+    fputs("{\"traceEvents\":[\n", out);
+    yf_trace_metadata(out, max_track);
+
+    YF_LIST_FOREACH_CUR(YF_LIST_CURSOR, data->jobs, job) {
+        if (job->start_ns != 0)
+            yf_trace_job(out, job, origin);
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+
+    return fclose(out) ? 1 : 0;
+
+}
@@ -0,0 +1,19 @@
+/**
+ * Writes a timeline of a build in the trace event format, which can be opened
+ * with chrome://tracing or Perfetto. Each job is one event, on the track it ran
+ * on, so it's easy to see where a build spends its time - and, once jobs run in
+ * parallel, how well they overlap.
+ */
+
+#ifndef DRIVER_TRACE_H
+#define DRIVER_TRACE_H
+
+#include <api/compilation-data.h>
+
+/**
+ * Write all jobs that have run to the given file. Returns 0 on success, or 1
+ * if the file couldn't be written.
+ */
+int yf_write_trace(const char * path, struct yf_compilation_data *);
+
+#endif /* DRIVER_TRACE_H */
@@ -1,39 +1,87 @@
 #include "gen.h"
 
-#include <stdarg.h>
-#include <stdio.h>
 #include <string.h> /* strcmp */
-#include <sys/stat.h>
 
 #include <api/abstract-tree.h>
 #include <api/operator.h>
 #include <gen/typegen.h>
+#include <util/strbuf.h>
 #include <util/yfc-out.h>
 
-static void yf_gen_program(struct yfa_program * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_vardecl(struct yfa_vardecl * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_funcdecl(struct yfa_funcdecl * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_expr(struct yfa_expr * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_bstmt(struct yfa_bstmt * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_return(struct yfa_return * node, FILE * out, struct yf_gen_info * i);
-static void yf_gen_if(struct yfa_if * node, FILE * out, struct yf_gen_info * i);
+static void yf_gen_program(struct yfa_program * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_vardecl(struct yfa_vardecl * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_funcdecl(struct yfa_funcdecl * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_expr(struct yfa_expr * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_bstmt(struct yfa_bstmt * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_return(struct yfa_return * node, struct yf_strbuf * out, struct yf_gen_info * i);
+static void yf_gen_if(struct yfa_if * node, struct yf_strbuf * out, struct yf_gen_info * i);
 
 static void indent(struct yf_gen_info * i) { ++i->tab_depth; }
 static void dedent(struct yf_gen_info * i) { --i->tab_depth; }
 
-static void yfg_print_line(FILE * out, char * data, struct yf_gen_info * i , ...) {
-    int it;
-    va_list args;
-    va_start(args, i);
-    vfprintf(out, data, args);
-    fprintf(out, "\n");
-    for (it = 0; it < i->tab_depth; it++) {
-        fprintf(out, "\t");
+static void yfg_print_line(struct yf_strbuf * out, const char * data, struct yf_gen_info * i) {
+    yf_strbuf_puts(out, data);
+    yf_strbuf_putc(out, '\n');
+    yf_strbuf_indent(out, i->tab_depth);
+}
+
+/**
+ * A string as a C literal - only quotes and backslashes need escaping in
+ * names and paths.
+ */
+static void yfg_print_string(struct yf_strbuf * out, const char * str) {
+    yf_strbuf_putc(out, '"');
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\')
+            yf_strbuf_putc(out, '\\');
+        yf_strbuf_putc(out, *str);
+    }
+    yf_strbuf_putc(out, '"');
+}
+
+/**
+ * Whether a function gets a counter with --instrument - only ones with a body
+ * that we generate do.
+ */
+static bool yfg_instrumented(struct yfa_funcdecl * fn, struct yf_gen_info * i) {
+    return i->instrument && fn->body && !fn->extc;
+}
+
+/**
+ * The C name of a symbol: path$to$foo$$name, with the prefix of the unit that
+ * declares it - which for a call into another module isn't this one.
+ */
+static void yfg_print_ident(
+    struct yf_strbuf * out, struct yf_gen_info * i, const struct yf_sym * sym,
+    const char * name
+) {
+    const char * p;
+    if (!sym->prefix || sym->prefix == i->yf_prefix) {
+        yf_strbuf_puts(out, i->gen_prefix);
+    } else {
+        for (p = sym->prefix; *p; ++p)
+            yf_strbuf_putc(out, *p == '.' ? '$' : *p);
     }
-    va_end(args);
+    yf_strbuf_append(out, "$$", 2);
+    yf_strbuf_puts(out, name);
 }
 
-void yf_gen_node(struct yf_ast_node * root, FILE *out, struct yf_gen_info * i) {
+/**
+ * The start of a declaration: its C type, its Y-flat type in a comment, and its
+ * global name.
+ */
+static void yfg_print_decl(
+    struct yf_strbuf * out, const char * ctype, const struct yfs_type * type,
+    struct yf_gen_info * i, const struct yf_sym * sym, const char * name
+) {
+    yf_strbuf_puts(out, ctype);
+    yf_strbuf_append(out, " /* ", 4);
+    yf_strbuf_puts(out, type->name);
+    yf_strbuf_append(out, " */ ", 4);
+    yfg_print_ident(out, i, sym, name);
+}
+
+void yf_gen_node(struct yf_ast_node * root, struct yf_strbuf * out, struct yf_gen_info * i) {
 
     switch (root->type) {
         case YFA_PROGRAM:
@@ -58,18 +106,35 @@ void yf_gen_node(struct yf_ast_node * root, FILE *out, struct yf_gen_info * i) {
             yf_gen_if(&root->ifstmt, out, i);
             break;
         case YFA_EMPTY:
-            fprintf(out, ";\n");
+            yf_strbuf_puts(out, ";\n");
             break;
     }
 
 }
 
+/**
+ * Whether a top-level declaration is left out, because the program can't
+ * reach it.
+ */
+static bool yfg_unreachable(struct yf_ast_node * decl) {
+    switch (decl->type) {
+        case YFA_FUNCDECL:
+            return !decl->funcdecl.name->reachable;
+        case YFA_VARDECL:
+            return !decl->vardecl.name->reachable;
+        default:
+            return false;
+    }
+}
+
 static void yf_gen_program(
-    struct yfa_program * node, FILE *out, struct yf_gen_info * i) {
+    struct yfa_program * node, struct yf_strbuf * out, struct yf_gen_info * i) {
 
     struct yf_ast_node * child;
 
-    YF_LIST_FOREACH(node->decls, child) {
+    YFA_FOREACH(node->decls, node->num_decls, child) {
+        if (yfg_unreachable(child))
+            continue;
         yf_gen_node(child, out, i);
         if (child->type == YFA_VARDECL)
             yfg_print_line(out, ";", i);
@@ -79,30 +144,44 @@ static void yf_gen_program(
 
 }
 
-static void yf_gen_vardecl(
-    struct yfa_vardecl * node, FILE * out, struct yf_gen_info * i) {
-    char typebuf[256];
-    yfg_ctype(256, typebuf, node->name->var.dtype);
-    fprintf(
-        out, "%s /* %s */ %s$$%s",
-        typebuf,
-        node->name->var.dtype->name,
-        i->gen_prefix,
+/**
+ * A variable declaration, without its initial value.
+ */
+static void yf_gen_vardecl_name(
+    struct yfa_vardecl * node, struct yf_strbuf * out, struct yf_gen_info * i) {
+    yfg_print_decl(
+        out, yfg_ctype(node->name->var.dtype), node->name->var.dtype, i, node->name,
         node->name->var.name
     );
+}
+
+static void yf_gen_vardecl(
+    struct yfa_vardecl * node, struct yf_strbuf * out, struct yf_gen_info * i) {
+    yf_gen_vardecl_name(node, out, i);
     if (node->expr) {
-        fprintf(out, " = ");
+        yf_strbuf_puts(out, " = ");
         yf_gen_node(node->expr, out, i);
     }
 }
 
-static void yf_gen_funcdecl(
-    struct yfa_funcdecl * node, FILE * out, struct yf_gen_info * i) {
+/**
+ * Whether a function gets internal linkage - it has a body, and it isn't main,
+ * from C, or used by another unit. The C compiler is then free to inline it
+ * everywhere, or drop it when it's never called.
+ */
+static bool yfg_static(struct yfa_funcdecl * node) {
+    return node->body && !node->extc && !node->name->exported
+        && strcmp(node->name->fn.name, "main");
+}
+
+/**
+ * A function's signature - its linkage, return type, name and parameters.
+ */
+static void yf_gen_funcdecl_head(
+    struct yfa_funcdecl * node, struct yf_strbuf * out, struct yf_gen_info * i) {
 
     struct yf_ast_node * child;
     int argct = 0;
-    char typebuf[256];
-    yfg_ctype(256, typebuf, node->name->fn.rtype);
 
     /* Hacky fix -- but it should work. */
     /* We need to check if the function is called "main" because the C compiler
@@ -112,63 +191,86 @@ static void yf_gen_funcdecl(
     /* TODO -- generate the correct cmdargs for this function. */
     /* TODO -- (elsewhere) check the args for main in Y-flat */
 
+    if (yfg_static(node))
+        yf_strbuf_puts(out, "static ");
+
     if (strcmp(node->name->fn.name, "main")) {
         if (node->extc) {
-            fprintf(out, "%s", node->name->fn.name);
+            yf_strbuf_puts(out, node->name->fn.name);
         } else {
-            fprintf(
-                out, "%s /* %s */ %s$$%s",
-                typebuf,
-                node->name->fn.rtype->name,
-                i->gen_prefix,
-                node->name->fn.name
+            yfg_print_decl(
+                out, yfg_ctype(node->name->fn.rtype), node->name->fn.rtype, i,
+                node->name, node->name->fn.name
             );
         }
     } else {
-        fprintf(out, "int main");
+        yf_strbuf_puts(out, "int main");
     }
 
-        fprintf(out, "(");
+    yf_strbuf_putc(out, '(');
 
     /* Generate param list */
 
-    YF_LIST_FOREACH(node->params, child) {
+    YFA_FOREACH(node->params, node->num_params, child) {
         if (argct)
-            fprintf(out, ", ");
-        if (!child) break;
+            yf_strbuf_puts(out, ", ");
         yf_gen_node(child, out, i);
         ++argct;
     }
 
-    fprintf(out, ") ");
+    yf_strbuf_putc(out, ')');
+
+}
+
+static void yf_gen_funcdecl(
+    struct yfa_funcdecl * node, struct yf_strbuf * out, struct yf_gen_info * i) {
+
+    yf_gen_funcdecl_head(node, out, i);
+    yf_strbuf_putc(out, ' ');
 
-    if (node->body == NULL)
-        fprintf(out, ";");
-    else
+    if (node->body == NULL) {
+        yf_strbuf_putc(out, ';');
+    } else if (yfg_instrumented(node, i)) {
+        /* The span ends however the function returns. */
+        yf_strbuf_putc(out, '{');
+        indent(i);
+        yfg_print_line(out, "", i);
+        yf_strbuf_puts(out,
+            "struct yfi_span yfi$span __attribute__((cleanup(yfi_end))) = { &");
+        yf_strbuf_puts(out, i->gen_prefix);
+        yf_strbuf_puts(out, "$$yfi$table[");
+        yf_strbuf_put_int(out, i->num_instrumented++);
+        yf_strbuf_puts(out, "], yfi_now() };");
+        yfg_print_line(out, "", i);
+        yf_gen_node(node->body, out, i);
+        dedent(i);
+        yfg_print_line(out, "", i);
+        yf_strbuf_putc(out, '}');
+    } else {
         yf_gen_node(node->body, out, i);
+    }
 
 }
 
 static void yf_gen_expr(
-    struct yfa_expr * node, FILE * out, struct yf_gen_info * i) {
+    struct yfa_expr * node, struct yf_strbuf * out, struct yf_gen_info * i) {
 
     struct yf_ast_node * call_arg;
     int argct;
 
     /* All expressions are surrounded in parens so C's operator precedence
      * is ignored. */
-    fprintf(out, "(");
+    yf_strbuf_putc(out, '(');
 
     switch (node->type) {
         case YFA_E_VALUE:
             switch (node->as.value.type) {
                 case YFA_V_LITERAL:
-                    fprintf(out, "%d", node->as.value.as.literal.val);
+                    yf_strbuf_put_int(out, node->as.value.as.literal.val);
                     break;
                 case YFA_V_IDENT:
-                    fprintf(
-                        out, "%s$$%s",
-                        i->gen_prefix,
+                    yfg_print_ident(
+                        out, i, node->as.value.as.identifier,
                         node->as.value.as.identifier->var.name
                     );
                     break;
@@ -176,108 +278,341 @@ static void yf_gen_expr(
             break;
         case YFA_E_BINARY:
             yf_gen_expr(node->as.binary.left, out, i);
-            fprintf(out, " %s ", get_op_string(node->as.binary.op));
+            yf_strbuf_putc(out, ' ');
+            yf_strbuf_puts(out, get_op_string(node->as.binary.op));
+            yf_strbuf_putc(out, ' ');
             yf_gen_expr(node->as.binary.right, out, i);
             break;
         case YFA_E_FUNCCALL:
-            fprintf(
-                out, "%s$$%s(",
-                i->gen_prefix, node->as.call.name->fn.name
+            yfg_print_ident(
+                out, i, node->as.call.name, node->as.call.name->fn.name
             );
+            yf_strbuf_putc(out, '(');
             argct = 0;
-            YF_LIST_FOREACH(node->as.call.args, call_arg) {
+            YFA_FOREACH(
+                node->as.call.args, node->as.call.num_args, call_arg
+            ) {
                 if (argct)
-                    fprintf(out, ", ");
-                if (!call_arg) break;
+                    yf_strbuf_puts(out, ", ");
                 yf_gen_node(call_arg, out, i);
                 ++argct;
             }
-            fprintf(out, ")");
+            yf_strbuf_putc(out, ')');
             break;
     }
 
-    fprintf(out, ")");
+    yf_strbuf_putc(out, ')');
 
 }
 
 static void yf_gen_bstmt(
-    struct yfa_bstmt * node, FILE * out, struct yf_gen_info * i) {
+    struct yfa_bstmt * node, struct yf_strbuf * out, struct yf_gen_info * i) {
     struct yf_ast_node * child;
-    fprintf(out, "{");
+    yf_strbuf_putc(out, '{');
     indent(i);
-    YF_LIST_FOREACH(node->stmts, child) {
+    YFA_FOREACH(node->stmts, node->num_stmts, child) {
         yfg_print_line(out, "", i);
         yf_gen_node(child, out, i);
-        fprintf(out, ";");
+        yf_strbuf_putc(out, ';');
     }
     dedent(i);
     yfg_print_line(out, "", i);
-    fprintf(out, "}");
+    yf_strbuf_putc(out, '}');
 }
 
 static void yf_gen_return(
-    struct yfa_return * node, FILE * out, struct yf_gen_info * i) {
-    fprintf(out, "return ");
+    struct yfa_return * node, struct yf_strbuf * out, struct yf_gen_info * i) {
+    yf_strbuf_puts(out, "return ");
     if (node->expr)
         yf_gen_node(node->expr, out, i);
 }
 
 static void yf_gen_if(
-    struct yfa_if * node, FILE * out, struct yf_gen_info * i) {
-    fprintf(out, "if (");
+    struct yfa_if * node, struct yf_strbuf * out, struct yf_gen_info * i) {
+    yf_strbuf_puts(out, "if (");
     yf_gen_node(node->cond, out, i);
     yfg_print_line(out, ") {", i);
         yf_gen_node(node->code, out, i);
     yfg_print_line(out, ";", i);
-    fprintf(out, "}");
+    yf_strbuf_putc(out, '}');
     if (node->elsebranch) {
         yfg_print_line(out, " else {", i);
         yf_gen_node(node->elsebranch, out, i);
         yfg_print_line(out, ";", i);
-        fprintf(out, "}");
+        yf_strbuf_putc(out, '}');
+    }
+}
+
+/**
+ * What every instrumented unit uses: a function's counters, the span of one
+ * call, and writing the counters out.
+ */
+static const char yfg_instrument_runtime[] =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <time.h>\n\n"
+    "struct yfi_entry {\n"
+    "    const char * name, * loc;\n"
+    "    unsigned long long calls, ns;\n"
+    "};\n\n"
+    "struct yfi_span {\n"
+    "    struct yfi_entry * entry;\n"
+    "    unsigned long long start;\n"
+    "};\n\n"
+    "static unsigned long long yfi_now(void) {\n"
+    "    struct timespec ts;\n"
+    "    clock_gettime(CLOCK_MONOTONIC, &ts);\n"
+    "    return ts.tv_sec * 1000000000ull + ts.tv_nsec;\n"
+    "}\n\n"
+    "static void yfi_end(struct yfi_span * span) {\n"
+    "    ++span->entry->calls;\n"
+    "    span->entry->ns += yfi_now() - span->start;\n"
+    "}\n\n"
+    "static void yfi_dump(struct yfi_entry * table, int count) {\n"
+    "    const char * path = getenv(\"YF_INSTRUMENT_OUT\");\n"
+    "    FILE * out = fopen(path ? path : \"yf-instrument.txt\", \"a\");\n"
+    "    int i;\n"
+    "    if (!out)\n"
+    "        return;\n"
+    "    for (i = 0; i < count; ++i) {\n"
+    "        if (table[i].calls)\n"
+    "            fprintf(out, \"%llu\\t%llu\\t%s\\t%s\\n\", table[i].calls,\n"
+    "                table[i].ns, table[i].loc, table[i].name);\n"
+    "    }\n"
+    "    fclose(out);\n"
+    "}\n\n";
+
+void yfg_gen_header(struct yf_strbuf * out, struct yf_gen_info * info) {
+    yf_strbuf_puts(out, "/* Generated by yfc. */\n\n");
+    yf_strbuf_puts(out, "#include <stdint.h>\n\n");
+    if (info->instrument)
+        yf_strbuf_puts(out, yfg_instrument_runtime);
+}
+
+/**
+ * The counters of a unit's functions, in the order they're generated in, with
+ * their Y-flat names and locations.
+ */
+static int yfg_gen_instrument_table(
+    struct yfa_program * program, struct yf_strbuf * out,
+    struct yf_gen_info * i
+) {
+
+    struct yf_ast_node * child;
+    struct yf_sym * sym;
+    int count = 0;
+
+    YFA_FOREACH(program->decls, program->num_decls, child) {
+        if (child->type != YFA_FUNCDECL || yfg_unreachable(child)
+            || !yfg_instrumented(&child->funcdecl, i))
+            continue;
+        if (!count++) {
+            yf_strbuf_puts(out, "static struct yfi_entry ");
+            yf_strbuf_puts(out, i->gen_prefix);
+            yf_strbuf_puts(out, "$$yfi$table[] = {\n");
+        }
+        /* Like path.to.foo::bar, at src/path/to/foo.yf:3:1 */
+        sym = child->funcdecl.name;
+        yf_strbuf_puts(out, "    { ");
+        yf_strbuf_putc(out, '"');
+        if (i->yf_prefix) {
+            yf_strbuf_puts(out, i->yf_prefix);
+            yf_strbuf_append(out, "::", 2);
+        }
+        yf_strbuf_puts(out, sym->fn.name);
+        yf_strbuf_puts(out, "\", ");
+        yfg_print_string(out, sym->loc.file ? sym->loc.file : "?");
+        yf_strbuf_puts(out, " \":");
+        yf_strbuf_put_int(out, sym->loc.line);
+        yf_strbuf_putc(out, ':');
+        yf_strbuf_put_int(out, sym->loc.column);
+        yf_strbuf_puts(out, "\" },\n");
+    }
+
+    if (count)
+        yf_strbuf_puts(out, "};\n\n");
+    return count;
+
+}
+
+/**
+ * Write out a unit's counters when the program exits.
+ */
+static void yfg_gen_instrument_dump(
+    int count, struct yf_strbuf * out, struct yf_gen_info * i
+) {
+    yf_strbuf_puts(out, "static void ");
+    yf_strbuf_puts(out, i->gen_prefix);
+    yf_strbuf_puts(out, "$$yfi$dump(void) {\n    yfi_dump(");
+    yf_strbuf_puts(out, i->gen_prefix);
+    yf_strbuf_puts(out, "$$yfi$table, ");
+    yf_strbuf_put_int(out, count);
+    yf_strbuf_puts(out, ");\n}\n\n");
+    yf_strbuf_puts(out, "__attribute__((constructor)) static void ");
+    yf_strbuf_puts(out, i->gen_prefix);
+    yf_strbuf_puts(out, "$$yfi$init(void) {\n    atexit(");
+    yf_strbuf_puts(out, i->gen_prefix);
+    yf_strbuf_puts(out, "$$yfi$dump);\n}\n\n");
+}
+
+/**
+ * A function's prototype, from its symbol. Returns false if a parameter's
+ * type isn't known.
+ */
+static bool yfg_gen_prototype(
+    struct yf_sym * sym, bool internal, struct yf_strbuf * out,
+    struct yf_gen_info * i
+) {
+
+    struct yfsn_param * param;
+    int argct = 0;
+
+    YF_VEC_FOREACH(sym->fn.params, param) {
+        if (!param->dtype)
+            return false;
     }
+
+    if (internal)
+        yf_strbuf_puts(out, "static ");
+    yfg_print_decl(
+        out, yfg_ctype(sym->fn.rtype), sym->fn.rtype, i, sym, sym->fn.name
+    );
+    yf_strbuf_putc(out, '(');
+    YF_VEC_FOREACH(sym->fn.params, param) {
+        if (argct++)
+            yf_strbuf_puts(out, ", ");
+        yf_strbuf_puts(out, yfg_ctype(param->dtype));
+    }
+    if (!argct)
+        yf_strbuf_puts(out, "void");
+    yf_strbuf_puts(out, ");\n");
+
+    return true;
+
 }
 
 /**
- * Because we create the output file in the form of 'bin/c/foo/bar/baz.yf',
- * we need to first mkdir() the enclosing directory, if it doesn't already
- * exist. To do that, we would replace the last slash with a \0, mkdir() the
- * path, and set it back.
- * However, we have to create ALL enclosing folders first, so we need to get
- * all slashes from left to right, and do this recursively.
+ * Declare a global that's defined in another file - or later in this one.
  */
-static int create_all_parent_dirs(char * path) {
-    char * slashloc = path;
-    while (slashloc) {
-        slashloc = strchr(slashloc, '/');
-        if (!slashloc)
+static void yfg_gen_decl(
+    struct yf_sym * sym, struct yf_gen_info * info, struct yf_strbuf * out
+) {
+
+    if (!sym->reachable)
+        return;
+
+    switch (sym->type) {
+        case YFS_VAR:
+            yf_strbuf_puts(out, "extern ");
+            yfg_print_decl(
+                out, yfg_ctype(sym->var.dtype), sym->var.dtype, info, sym,
+                sym->var.name
+            );
+            yf_strbuf_append(out, ";\n", 2);
+            break;
+        case YFS_FN:
+            /* main isn't called from Y-flat, and a function no other unit
+            uses is declared by its own unit, as static. */
+            if (sym->exported && strcmp(sym->fn.name, "main"))
+                yfg_gen_prototype(sym, false, out, info);
             break;
-        *slashloc = '\0';
-        mkdir(path, 0755);
-        /* Now, we move the loc one forward, and search for the new slash. */
-        *slashloc = '/';
-        ++slashloc;
     }
-    return 0;
+
+}
+
+int yfg_gen_decls(
+    struct yfs_symtab * symtab, struct yf_gen_info * info,
+    struct yf_strbuf * out
+) {
+
+    struct yfh_cursor cursor;
+    const char * name;
+    struct yf_sym * sym;
+
+    for (yfh_cursor_init(&cursor, &symtab->table); !yfh_cursor_next(&cursor); ) {
+        yfh_cursor_get(&cursor, &name, (void **) &sym);
+        yfg_gen_decl(sym, info, out);
+    }
+
+    return out->failed;
+
+}
+
+/**
+ * Declare what a unit uses of the others, which are compiled on their own.
+ */
+static void yfg_gen_imports(
+    struct yf_compile_analyse_job * data, struct yf_gen_info * info,
+    struct yf_strbuf * out
+) {
+
+    struct yf_sym * sym;
+
+    YF_VEC_FOREACH(data->imports, sym) {
+        yfg_gen_decl(sym, info, out);
+    }
+
+    if (yf_vec_count(&data->imports))
+        yf_strbuf_putc(out, '\n');
+
+}
+
+/**
+ * Declare the functions a unit defines before any code, so that they can be
+ * called before they're defined. Static functions have to be declared static
+ * from the start.
+ */
+static void yfg_gen_forward(
+    struct yfa_program * node, struct yf_strbuf * out, struct yf_gen_info * i
+) {
+
+    struct yf_ast_node * child;
+    struct yfa_funcdecl * fn;
+    bool any = false;
+
+    YFA_FOREACH(node->decls, node->num_decls, child) {
+        if (child->type != YFA_FUNCDECL || yfg_unreachable(child))
+            continue;
+        fn = &child->funcdecl;
+        if (!fn->body || fn->extc || !strcmp(fn->name->fn.name, "main"))
+            continue;
+        any |= yfg_gen_prototype(fn->name, yfg_static(fn), out, i);
+    }
+
+    if (any)
+        yf_strbuf_putc(out, '\n');
+
 }
 
-int yfg_gen(struct yf_compile_analyse_job * data, struct yf_gen_info * info) {
+int yfg_gen_unit(
+    struct yf_compile_analyse_job * data, struct yf_gen_info * info,
+    struct yf_strbuf * out
+) {
 
-    create_all_parent_dirs(data->unit_info->output_file);
+    int instrumented = 0;
 
-    FILE * out;
-    out = fopen(data->unit_info->output_file, "w");
-    if (!out) {
-        YF_PRINT_ERROR("could not open output file %s", data->unit_info->output_file);
-        return 1;
+    info->num_instrumented = 0;
+    if (info->instrument) {
+        instrumented = yfg_gen_instrument_table(
+            &data->ast_tree.root.program, out, info
+        );
     }
 
-    fprintf(out, "/* Generated by yfc. */\n\n");
-    fprintf(out, "#include <stdint.h>\n\n");
+    yfg_gen_forward(&data->ast_tree.root.program, out, info);
+    yf_gen_node(&data->ast_tree.root, out, info);
+
+    if (instrumented)
+        yfg_gen_instrument_dump(instrumented, out, info);
 
-    yf_gen_node(&data->ast_tree, out, info);
+    return out->failed;
 
-    fclose(out);
-    return 0;
+}
 
+int yfg_gen(
+    struct yf_compile_analyse_job * data, struct yf_gen_info * info,
+    struct yf_strbuf * out
+) {
+    yfg_gen_header(out, info);
+    yfg_gen_imports(data, info, out);
+    return yfg_gen_unit(data, info, out);
 }
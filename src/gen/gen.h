@@ -7,7 +7,49 @@
 
 #include <api/compilation-data.h>
 #include <api/generation.h>
+#include <util/strbuf.h>
 
-int yfg_gen(struct yf_compile_analyse_job * data, struct yf_gen_info * info);
+/**
+ * The version of the generated code. Bump it whenever the same program would
+ * be generated differently, so that C code written by an older yfc is never
+ * mistaken for current.
+ */
+#define YFG_VERSION 2
+
+/**
+ * Append the comment and includes that start every generated C file - and with
+ * --instrument, what the counters of each unit need.
+ */
+void yfg_gen_header(struct yf_strbuf * out, struct yf_gen_info * info);
+
+/**
+ * Append declarations of the globals and functions in a unit's symbol table
+ * that the program can reach, so that code appended after them can use them,
+ * whether or not the unit has been validated. Returns 1 if we ran out of
+ * memory.
+ */
+int yfg_gen_decls(
+    struct yfs_symtab * symtab, struct yf_gen_info * info,
+    struct yf_strbuf * out
+);
+
+/**
+ * Append the code of a unit, without a header. Returns 1 if we ran out of
+ * memory.
+ */
+int yfg_gen_unit(
+    struct yf_compile_analyse_job * data, struct yf_gen_info * info,
+    struct yf_strbuf * out
+);
+
+/**
+ * Append the C code of a unit to a buffer, as a file of its own - after the
+ * header, it declares the globals of other units that it uses. Returns 1 if we
+ * ran out of memory.
+ */
+int yfg_gen(
+    struct yf_compile_analyse_job * data, struct yf_gen_info * info,
+    struct yf_strbuf * out
+);
 
 #endif /* GEN_GEN_H */
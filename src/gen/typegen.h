@@ -8,11 +8,9 @@
 #include <api/sym.h>
 
 /**
- * Stuff a C form of a type into a buffer.
- *  0 - success
- *  1 - overflow
- * -1 - other error
+ * The C form of a type - the spelling kept with the type. A type that can't be
+ * written in C is reported, and its own name is given back.
  */
-int yfg_ctype(int len, char * buf, struct yfs_type * type);
+const char * yfg_ctype(const struct yfs_type * type);
 
 #endif /* YF_GEN_TYPEGEN_H */
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include <lexer/keywords.h>
+#include <util/profile.h>
 #include <util/yfc-out.h>
 
 /**
@@ -41,12 +42,18 @@ void yfl_init(
     lexer->input = input;
     lexer->unlex_ct = 0;
 
+    lexer->num_tokens = 0;
+    lexer->lex_ns = 0;
+
 }
 
 /**
  * Stuff a token with data.
  */
 enum yfl_code yfl_lex(struct yf_lexer * lexer, struct yf_token * token) {
+
+    uint64_t start;
+    enum yfl_code ret;
     
     if (lexer->unlex_ct > 0) {
         /* We have unlexed tokens, so use them */
@@ -54,7 +61,14 @@ enum yfl_code yfl_lex(struct yf_lexer * lexer, struct yf_token * token) {
         lexer->unlex_ct--;
         return YFLC_OK;
     } else {
-        return yfl_core_lex(lexer, token);
+        ++lexer->num_tokens;
+        if (!yf_profiling)
+            return yfl_core_lex(lexer, token);
+        /* Lexing is interleaved with parsing, so time each token. */
+        start = yf_profile_now();
+        ret = yfl_core_lex(lexer, token);
+        lexer->lex_ns += yf_profile_now() - start;
+        return ret;
     }
 
 }
@@ -6,6 +6,8 @@
 #ifndef LEXER_LEXER_H
 #define LEXER_LEXER_H
 
+#include <stdint.h>
+
 #include <api/lexer-input.h>
 #include <api/loc.h>
 #include <api/tokens.h>
@@ -23,6 +25,11 @@ struct yf_lexer {
     struct yf_token unlex_buf[16];
     int unlex_ct;
 
+    /* Tokens lexed (not counting unlexed ones handed out again), and the time
+    spent lexing them - only measured when profiling. */
+    unsigned long num_tokens;
+    uint64_t lex_ns;
+
 };
 
 /**
@@ -55,6 +55,7 @@ int yfp_if(struct yf_parse_node * node, struct yf_lexer * lexer) {
             return 1;
         }
     } else {
+        i->elsebranch = NULL;
         yfl_unlex(lexer, &tok);
     }
 
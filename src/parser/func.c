@@ -19,7 +19,7 @@ int yfp_funcdecl(struct yf_parse_node * node, struct yf_lexer * lexer) {
     node->funcdecl.extc = false;
 
     /* Start arg list for writing */
-    yf_list_init(&node->funcdecl.params);
+    yf_vec_init(&node->funcdecl.params);
     argct = 0;
 
     for (;;) {
@@ -54,14 +54,14 @@ int yfp_funcdecl(struct yf_parse_node * node, struct yf_lexer * lexer) {
         }
         argp->vardecl.name = ident;
         if (yfp_vardecl(argp, lexer)) {
-            free(argp);
+            yf_free(argp);
             return 1;
         }
 
         ++argct;
 
         /* Add to arg list */
-        yf_list_add(&node->funcdecl.params, argp);
+        yf_vec_add(&node->funcdecl.params, argp);
 
     }
 
@@ -27,7 +27,7 @@ int yfp_program(struct yf_parse_node * node, struct yf_lexer * lexer) {
     node->loc.line = node->loc.column = -1;
 
     node->type = YFCS_PROGRAM;
-    yf_list_init(&node->program.decls);
+    yf_vec_init(&node->program.decls);
 
     for (;;) {
 
@@ -44,7 +44,7 @@ int yfp_program(struct yf_parse_node * node, struct yf_lexer * lexer) {
         /* Do end-of-file peek back here. */
         P_PEEK(lexer, &tok);
         if (tok.type == YFT_EOF) {
-            free(decl);
+            yf_free(decl);
             return 0;
         }
         
@@ -56,7 +56,7 @@ int yfp_program(struct yf_parse_node * node, struct yf_lexer * lexer) {
             case YFT_COLON:
                 decl->vardecl.name = ident;
                 if (yfp_vardecl(decl, lexer)) {
-                    free(decl);
+                    yf_free(decl);
                     return 1;
                 }
                 /* It's a top-level decl, so expect a semicolon. */
@@ -68,7 +68,7 @@ int yfp_program(struct yf_parse_node * node, struct yf_lexer * lexer) {
             case YFT_OPAREN:
                 decl->funcdecl.name = ident;
                 if (yfp_funcdecl(decl, lexer)) {
-                    free(decl);
+                    yf_free(decl);
                     return 1;
                 }
                 break;
@@ -78,7 +78,7 @@ int yfp_program(struct yf_parse_node * node, struct yf_lexer * lexer) {
         }
 
         /* Now, we have a node - add it to the list. */
-        yf_list_add(&node->program.decls, decl);
+        yf_vec_add(&node->program.decls, decl);
 
     }
 
@@ -117,7 +117,7 @@ int yfp_vardecl(struct yf_parse_node * node, struct yf_lexer * lexer) {
         }
             node->vardecl.expr = yf_malloc(sizeof(struct yf_parse_node));
             if (yfp_expr(node->vardecl.expr, lexer, 0, NULL)) {
-                free(node->vardecl.expr);
+                yf_free(node->vardecl.expr);
                 return 1;
             }
             break;
@@ -258,7 +258,7 @@ int yfp_bstmt(struct yf_parse_node * node, struct yf_lexer * lexer) {
     P_GETCT(node, tok);
 
     node->type = YFCS_BSTMT;
-    yf_list_init(&node->bstmt.stmts);
+    yf_vec_init(&node->bstmt.stmts);
 
     for (;;) {
         P_PEEK(lexer, &tok);
@@ -269,10 +269,10 @@ int yfp_bstmt(struct yf_parse_node * node, struct yf_lexer * lexer) {
         }
         stmt = yf_malloc(sizeof (struct yf_parse_node));
         if (yfp_stmt(stmt, lexer)) {
-            free(stmt);
+            yf_free(stmt);
             return 1;
         }
-        yf_list_add(&node->bstmt.stmts, stmt);
+        yf_vec_add(&node->bstmt.stmts, stmt);
     }
 
 }
@@ -34,11 +34,7 @@ int yfp_stmt(struct yf_parse_node * node, struct yf_lexer * lexer) {
                 return 1;
             P_LEX(lexer, &tok);
             if (tok.type == YFT_COLON) {
-                /* TODO - reduce the copied code */
-                strcpy(
-                    node->vardecl.name.name,
-                    ident.expr.value.identifier.name
-                );
+                node->vardecl.name = ident.expr.value.identifier;
                 ret = yfp_vardecl(node, lexer);
                 goto out;
             /* Expression or funccall */
@@ -111,7 +107,7 @@ int yfp_funccall(struct yf_parse_node * node, struct yf_lexer * lexer) {
      */
 
     /* Start arg list for writing */
-    yf_list_init(&node->expr.call.args);
+    yf_vec_init(&node->expr.call.args);
     argct = 0;
 
     for (;;) {
@@ -143,7 +139,7 @@ int yfp_funccall(struct yf_parse_node * node, struct yf_lexer * lexer) {
         ++argct;
 
         /* Add to arg list */
-        yf_list_add(&node->expr.call.args, argp);
+        yf_vec_add(&node->expr.call.args, argp);
 
     }
 
@@ -0,0 +1,316 @@
+#include "fold.h"
+
+#include <limits.h>
+#include <stdbool.h>
+
+#include <api/abstract-tree.h>
+#include <semantics/types.h>
+
+static void fold_node(
+    struct yf_compile_analyse_job * udata, struct yf_ast_node * node
+);
+
+/**
+ * Whether an expression is a literal, and if so, its value.
+ */
+static bool fold_literal(struct yfa_expr * expr, long long * val) {
+
+    if (expr->type != YFA_E_VALUE || expr->as.value.type != YFA_V_LITERAL)
+        return false;
+
+    *val = expr->as.value.as.literal.val;
+    return true;
+
+}
+
+static bool fold_is(struct yfa_expr * expr, long long val) {
+    long long lit;
+    return fold_literal(expr, &lit) && lit == val;
+}
+
+/**
+ * Whether an expression can be left out without changing what the program
+ * does - it calls nothing and assigns nothing.
+ */
+static bool fold_pure(struct yfa_expr * expr) {
+
+    switch (expr->type) {
+        case YFA_E_VALUE:
+            return true;
+        case YFA_E_BINARY:
+            return !yfo_is_assign(expr->as.binary.op)
+                && fold_pure(expr->as.binary.left)
+                && fold_pure(expr->as.binary.right);
+        case YFA_E_FUNCCALL:
+            return false;
+    }
+
+    return false;
+
+}
+
+static bool fold_is_int(const struct yfs_type * type) {
+    return type && type->kind == YFS_T_PRIMITIVE
+        && type->primitive.type == YFS_F_INT && type->primitive.size > 0;
+}
+
+/**
+ * Whether a value fits in an integer type without overflowing, so that an
+ * expression of that type can be replaced by it. The smallest value of a type
+ * is left out too - the literal would be written as the negation of a number
+ * that doesn't fit.
+ */
+static bool fold_fits(long long val, const struct yfs_type * type) {
+
+    long long max;
+
+    if (!fold_is_int(type))
+        return false;
+
+    if (type->primitive.size == 1)
+        return val == 0 || val == 1;
+
+    if (type->primitive.size >= 64)
+        max = LLONG_MAX;
+    else
+        max = (1LL << (type->primitive.size - 1)) - 1;
+
+    /* Literals are an int - one in place of a wider expression would make the
+    arithmetic around it narrower too. */
+    if (max > INT_MAX)
+        return false;
+
+    return val >= -max && val <= max;
+
+}
+
+/**
+ * Apply an operator to two constants. Both are small enough that nothing here
+ * overflows. Returns false if the operation can't be done at compile time.
+ */
+static bool fold_eval(
+    enum yf_operator op, long long l, long long r, long long * out
+) {
+
+    switch (op) {
+        case YFO_ADD: *out = l + r; break;
+        case YFO_SUB: *out = l - r; break;
+        case YFO_MUL: *out = l * r; break;
+        /* Division by zero is left for the program to do. */
+        case YFO_DIV: if (!r) return false; *out = l / r; break;
+        case YFO_MOD: if (!r) return false; *out = l % r; break;
+        case YFO_EQ:  *out = l == r; break;
+        case YFO_NEQ: *out = l != r; break;
+        case YFO_LT:  *out = l < r; break;
+        case YFO_LTE: *out = l <= r; break;
+        case YFO_GT:  *out = l > r; break;
+        case YFO_GTE: *out = l >= r; break;
+        case YFO_AND: *out = l & r; break;
+        case YFO_OR:  *out = l | r; break;
+        case YFO_XOR: *out = l ^ r; break;
+        default:
+            return false;
+    }
+
+    return true;
+
+}
+
+/**
+ * Replace an expression with a literal of its type. The value has to fit.
+ */
+static void fold_set(
+    struct yfa_expr * expr, long long val, const struct yfs_type * type
+) {
+    expr->type = YFA_E_VALUE;
+    expr->as.value.type = YFA_V_LITERAL;
+    expr->as.value.as.literal.type =
+        type->builtin == YFS_B_BOOL ? YFA_L_BOOL : YFA_L_NUM;
+    expr->as.value.as.literal.val = val;
+}
+
+/**
+ * Drop the operations that give back one of their operands unchanged, or a
+ * constant no matter what the other operand is. Only integers are simplified -
+ * for floating-point numbers, x + 0 isn't always x.
+ */
+static void fold_identity(
+    struct yf_compile_analyse_job * udata, struct yfa_expr * expr,
+    const struct yfs_type * type
+) {
+
+    struct yfa_expr * l = expr->as.binary.left, * r = expr->as.binary.right;
+    bool lbool, rbool;
+
+    if (!fold_is_int(type) || !fold_is_int(yfse_get_expr_type(l, udata))
+        || !fold_is_int(yfse_get_expr_type(r, udata)))
+        return;
+
+    /* 'true' only leaves a bool alone - x & 1 is not x for other integers. */
+    lbool = yfse_get_expr_type(l, udata)->builtin == YFS_B_BOOL;
+    rbool = yfse_get_expr_type(r, udata)->builtin == YFS_B_BOOL;
+
+    switch (expr->as.binary.op) {
+        case YFO_ADD:
+        case YFO_OR:
+        case YFO_XOR:
+            if (fold_is(r, 0))
+                *expr = *l;
+            else if (fold_is(l, 0))
+                *expr = *r;
+            else if (expr->as.binary.op == YFO_OR && lbool && rbool
+                && (fold_is(l, 1) || fold_is(r, 1)) && fold_pure(l)
+                && fold_pure(r) && fold_fits(1, type))
+                fold_set(expr, 1, type);
+            break;
+        case YFO_SUB:
+            if (fold_is(r, 0))
+                *expr = *l;
+            break;
+        case YFO_MUL:
+            if (fold_is(r, 1))
+                *expr = *l;
+            else if (fold_is(l, 1))
+                *expr = *r;
+            else if ((fold_is(l, 0) || fold_is(r, 0))
+                && fold_pure(l) && fold_pure(r) && fold_fits(0, type))
+                fold_set(expr, 0, type);
+            break;
+        case YFO_DIV:
+            if (fold_is(r, 1))
+                *expr = *l;
+            break;
+        case YFO_AND:
+            if (lbool && rbool && fold_is(r, 1))
+                *expr = *l;
+            else if (lbool && rbool && fold_is(l, 1))
+                *expr = *r;
+            else if ((fold_is(l, 0) || fold_is(r, 0))
+                && fold_pure(l) && fold_pure(r) && fold_fits(0, type))
+                fold_set(expr, 0, type);
+            break;
+        default:
+            break;
+    }
+
+}
+
+static void fold_expr(
+    struct yf_compile_analyse_job * udata, struct yfa_expr * expr
+) {
+
+    struct yf_ast_node * arg;
+    const struct yfs_type * type;
+    long long l, r, val;
+
+    switch (expr->type) {
+        case YFA_E_VALUE:
+            return;
+        case YFA_E_FUNCCALL:
+            YFA_FOREACH(expr->as.call.args, expr->as.call.num_args, arg) {
+                fold_node(udata, arg);
+            }
+            return;
+        case YFA_E_BINARY:
+            break;
+    }
+
+    /* The left side of an assignment is where the value goes. */
+    if (yfo_is_assign(expr->as.binary.op)) {
+        fold_expr(udata, expr->as.binary.right);
+        return;
+    }
+
+    /* What the result has to fit in. This is taken before the operands are
+    folded - a long operand that becomes a literal would make it an int. */
+    type = yfse_get_expr_type(expr, udata);
+
+    fold_expr(udata, expr->as.binary.left);
+    fold_expr(udata, expr->as.binary.right);
+
+    if (fold_literal(expr->as.binary.left, &l)
+        && fold_literal(expr->as.binary.right, &r)) {
+        /* Anything that would overflow is left as it is, so that the program
+        does the same thing it would have without folding. */
+        if (fold_eval(expr->as.binary.op, l, r, &val) && fold_fits(val, type))
+            fold_set(expr, val, type);
+        return;
+    }
+
+    fold_identity(udata, expr, type);
+
+}
+
+/**
+ * An if statement with a constant condition is replaced by the branch that is
+ * taken - or by an empty statement, if there's nothing to take.
+ */
+static void fold_if(
+    struct yf_compile_analyse_job * udata, struct yf_ast_node * node
+) {
+
+    struct yfa_if * ifstmt = &node->ifstmt;
+    long long cond;
+
+    fold_node(udata, ifstmt->cond);
+    fold_node(udata, ifstmt->code);
+    if (ifstmt->elsebranch)
+        fold_node(udata, ifstmt->elsebranch);
+
+    if (ifstmt->cond->type != YFA_EXPR
+        || !fold_literal(&ifstmt->cond->expr, &cond))
+        return;
+
+    if (cond)
+        *node = *ifstmt->code;
+    else if (ifstmt->elsebranch)
+        *node = *ifstmt->elsebranch;
+    else
+        node->type = YFA_EMPTY;
+
+}
+
+static void fold_node(
+    struct yf_compile_analyse_job * udata, struct yf_ast_node * node
+) {
+
+    struct yf_ast_node * child;
+
+    switch (node->type) {
+        case YFA_EXPR:
+            fold_expr(udata, &node->expr);
+            break;
+        case YFA_VARDECL:
+            if (node->vardecl.expr)
+                fold_node(udata, node->vardecl.expr);
+            break;
+        case YFA_FUNCDECL:
+            if (node->funcdecl.body)
+                fold_node(udata, node->funcdecl.body);
+            break;
+        case YFA_PROGRAM:
+            YFA_FOREACH(node->program.decls, node->program.num_decls, child) {
+                fold_node(udata, child);
+            }
+            break;
+        case YFA_BSTMT:
+            YFA_FOREACH(node->bstmt.stmts, node->bstmt.num_stmts, child) {
+                fold_node(udata, child);
+            }
+            break;
+        case YFA_RETURN:
+            if (node->ret.expr)
+                fold_node(udata, node->ret.expr);
+            break;
+        case YFA_IF:
+            fold_if(udata, node);
+            break;
+        case YFA_EMPTY:
+            break;
+    }
+
+}
+
+void yfs_fold(struct yf_compile_analyse_job * udata) {
+    fold_node(udata, &udata->ast_tree.root);
+}
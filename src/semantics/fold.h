@@ -0,0 +1,19 @@
+/**
+ * Constant folding - simplify a validated tree before code is generated from
+ * it.
+ */
+
+#ifndef SEMANTICS_FOLD_H
+#define SEMANTICS_FOLD_H
+
+#include <api/compilation-data.h>
+
+/**
+ * Fold the expressions of a unit's tree whose operands are all constants,
+ * drop operations that do nothing, like x * 1, and replace if statements with
+ * constant conditions by the branch that is taken. The tree must have been
+ * validated. Nothing is allocated, so this can't fail.
+ */
+void yfs_fold(struct yf_compile_analyse_job * udata);
+
+#endif /* SEMANTICS_FOLD_H */
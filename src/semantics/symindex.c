@@ -0,0 +1,475 @@
+#include "symindex.h"
+
+#include <string.h>
+
+#include <api/concrete-tree.h>
+#include <util/allocator.h>
+#include <util/hash.h>
+#include <util/yfc-out.h>
+
+/**
+ * FNV-1a over the name, seeded with the module ID.
+ */
+static unsigned long index_hash(unsigned module, const char * name) {
+
+    unsigned long hash = 2166136261UL ^ module;
+
+    for (; *name; ++name) {
+        hash ^= (unsigned char) *name;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+
+}
+
+static int index_add(
+    struct yfs_symbol_index * index,
+    unsigned module, const char * name, struct yf_sym * sym
+) {
+
+    struct yfs_index_entry * entry;
+    unsigned long hash, mask, i;
+
+    hash = index_hash(module, name);
+    mask = index->num_entries - 1;
+
+    /* The table is never more than half full, so this terminates. */
+    for (i = hash & mask; index->entries[i].sym; i = (i + 1) & mask)
+        ;
+
+    entry = &index->entries[i];
+    entry->hash = hash;
+    entry->module = module;
+    entry->sym = sym;
+    if ( (entry->name = yf_intern(&index->names, name)) == NULL)
+        return 3;
+
+    if (sym->type == YFS_FN && strcmp(name, "main") == 0) {
+        index->entry_point = sym;
+        ++index->num_entry_points;
+    }
+
+    return 0;
+
+}
+
+/**
+ * Find the entry of a global symbol, or NULL if there's none.
+ */
+static struct yfs_index_entry * index_find(
+    struct yfs_symbol_index * index, unsigned module, const char * name
+) {
+
+    struct yfs_index_entry * entry;
+    unsigned long hash, mask, i;
+
+    if (!index->num_entries)
+        return NULL;
+
+    hash = index_hash(module, name);
+    mask = index->num_entries - 1;
+
+    for (i = hash & mask; (entry = &index->entries[i])->sym; i = (i + 1) & mask) {
+        if (entry->hash == hash && entry->module == module
+            && strcmp(entry->name, name) == 0)
+            return entry;
+    }
+
+    return NULL;
+
+}
+
+/**
+ * Called for every identifier in a parse tree, with the module the tree is
+ * from.
+ */
+typedef void (*index_visit_fn)(
+    struct yfs_symbol_index *, unsigned from, struct yfcs_identifier *,
+    void * ctx
+);
+
+/**
+ * What one unit uses of the others.
+ */
+struct index_imports {
+    struct yf_vec * syms;
+    bool failed;
+};
+
+/**
+ * Mark the global an identifier names as exported, if it's in another module,
+ * and add it to the imports of the module it's used from. Identifiers that
+ * don't resolve are left for validation to report.
+ */
+static void index_mark_export(
+    struct yfs_symbol_index * index, unsigned from,
+    struct yfcs_identifier * id, void * ctx
+) {
+
+    struct index_imports * imports = ctx;
+    int module;
+    struct yf_sym * sym, * imported = NULL;
+
+    if (!id->filepath[0])
+        return;
+    module = yfs_index_find_module(index, id->filepath);
+    if (module == -1 || (unsigned) module == from)
+        return;
+    sym = yfs_index_lookup(index, module, id->name);
+    if (!sym)
+        return;
+
+    /* A unit only uses a few globals of others, so a search is enough. */
+    YF_VEC_FOREACH(*imports->syms, imported) {
+        if (imported == sym)
+            break;
+    }
+    if (imported != sym && yf_vec_add(imports->syms, sym))
+        imports->failed = true;
+
+    if (sym->exported)
+        return;
+
+    sym->exported = true;
+    index->usage_hash += yf_hash_str(id->name, yf_hash_str(id->filepath, 0));
+
+}
+
+static void index_walk(
+    struct yfs_symbol_index * index, unsigned from,
+    struct yf_parse_node * node, index_visit_fn visit, void * ctx
+);
+
+/**
+ * The operands of a binary expression are only ever expressions, and the
+ * parser doesn't always tag them as such - so they're walked as expressions,
+ * without looking at the type of the node.
+ */
+static void index_walk_expr(
+    struct yfs_symbol_index * index, unsigned from,
+    struct yfcs_expr * expr, index_visit_fn visit, void * ctx
+) {
+
+    struct yf_parse_node * child;
+
+    switch (expr->type) {
+        case YFCS_E_VALUE:
+            if (expr->value.type == YFCS_V_IDENT)
+                visit(index, from, &expr->value.identifier, ctx);
+            break;
+        case YFCS_E_BINARY:
+            index_walk_expr(index, from, &expr->binary.left->expr, visit, ctx);
+            index_walk_expr(
+                index, from, &expr->binary.right->expr, visit, ctx
+            );
+            break;
+        case YFCS_E_FUNCCALL:
+            visit(index, from, &expr->call.name, ctx);
+            YF_VEC_FOREACH(expr->call.args, child) {
+                index_walk(index, from, child, visit, ctx);
+            }
+            break;
+    }
+
+}
+
+/**
+ * Visit every identifier used in a parse tree - the names of declarations
+ * aren't uses, and aren't visited.
+ */
+static void index_walk(
+    struct yfs_symbol_index * index, unsigned from,
+    struct yf_parse_node * node, index_visit_fn visit, void * ctx
+) {
+
+    struct yf_parse_node * child;
+
+    if (!node)
+        return;
+
+    switch (node->type) {
+        case YFCS_EXPR:
+            index_walk_expr(index, from, &node->expr, visit, ctx);
+            break;
+        case YFCS_VARDECL:
+            index_walk(index, from, node->vardecl.expr, visit, ctx);
+            break;
+        case YFCS_FUNCDECL:
+            index_walk(index, from, node->funcdecl.body, visit, ctx);
+            break;
+        case YFCS_PROGRAM:
+            YF_VEC_FOREACH(node->program.decls, child) {
+                index_walk(index, from, child, visit, ctx);
+            }
+            break;
+        case YFCS_BSTMT:
+            YF_VEC_FOREACH(node->bstmt.stmts, child) {
+                index_walk(index, from, child, visit, ctx);
+            }
+            break;
+        case YFCS_RET:
+            index_walk(index, from, node->ret.expr, visit, ctx);
+            break;
+        case YFCS_IF:
+            index_walk(index, from, node->ifstmt.cond, visit, ctx);
+            index_walk(index, from, node->ifstmt.code, visit, ctx);
+            index_walk(index, from, node->ifstmt.elsebranch, visit, ctx);
+            break;
+        case YFCS_EMPTY:
+            break;
+    }
+
+}
+
+int yfs_build_symbol_index(
+    struct yfs_symbol_index * index, struct yf_compilation_data * pdata
+) {
+
+    struct yf_list_cursor jobs;
+    struct yf_compilation_job * job;
+    struct yf_compile_analyse_job * adata;
+    struct yfs_index_module * module;
+    struct yfh_cursor cursor;
+    const char * name;
+    struct yf_sym * sym;
+    struct index_imports imports = { NULL, false };
+    unsigned long num_syms = 0;
+
+    memset(index, 0, sizeof *index);
+
+    /* Count modules and symbols first, so nothing is resized later. */
+    YF_LIST_FOREACH_CUR(jobs, pdata->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        adata = (struct yf_compile_analyse_job *) job;
+        if (!adata->symtab.table.buckets)
+            continue;
+        ++index->num_modules;
+        for (yfh_cursor_init(&cursor, &adata->symtab.table);
+            !yfh_cursor_next(&cursor); ++num_syms)
+            ;
+    }
+
+    for (index->num_entries = 16; index->num_entries < num_syms * 2; )
+        index->num_entries <<= 1;
+
+    index->modules = yf_calloc(
+        index->num_modules ? index->num_modules : 1, sizeof *index->modules
+    );
+    index->entries = yf_calloc(index->num_entries, sizeof *index->entries);
+    yfh_init(&index->module_map);
+    if (!index->modules || !index->entries || !index->module_map.buckets
+        || yf_intern_init(&index->names))
+        return 3;
+
+    module = index->modules;
+    YF_LIST_FOREACH_CUR(jobs, pdata->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        adata = (struct yf_compile_analyse_job *) job;
+        if (!adata->symtab.table.buckets)
+            continue;
+
+        module->prefix = adata->unit_info->file_prefix;
+        module->symtab = &adata->symtab;
+        if (module->prefix && yfh_set(
+            &index->module_map, module->prefix, module
+        ))
+            return 3;
+
+        for (yfh_cursor_init(&cursor, &adata->symtab.table);
+            !yfh_cursor_next(&cursor); ) {
+            yfh_cursor_get(&cursor, &name, (void **) &sym);
+            if (index_add(index, module - index->modules, name, sym))
+                return 3;
+        }
+
+        ++module;
+    }
+
+    /* Every parse tree is still around, so what each unit uses of the others
+    is known before any of them is validated. */
+    module = index->modules;
+    YF_LIST_FOREACH_CUR(jobs, pdata->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        adata = (struct yf_compile_analyse_job *) job;
+        if (!adata->symtab.table.buckets)
+            continue;
+        imports.syms = &adata->imports;
+        index_walk(
+            index, module - index->modules, &adata->parse_tree,
+            index_mark_export, &imports
+        );
+        if (imports.failed)
+            return 3;
+        ++module;
+    }
+
+    if (index->num_entry_points != 1)
+        index->entry_point = NULL;
+
+    return 0;
+
+}
+
+int yfs_index_find_module(
+    struct yfs_symbol_index * index, const char * prefix
+) {
+
+    struct yfs_index_module * module;
+
+    if (!index->module_map.buckets)
+        return -1;
+    if (yfh_get(&index->module_map, prefix, (void **) &module))
+        return -1;
+
+    return module - index->modules;
+
+}
+
+struct yf_sym * yfs_index_lookup(
+    struct yfs_symbol_index * index, unsigned module, const char * name
+) {
+    struct yfs_index_entry * entry = index_find(index, module, name);
+    return entry ? entry->sym : NULL;
+}
+
+/**
+ * What is left to do while finding reachable globals.
+ */
+struct index_reach {
+
+    /* The declaration of each entry, by its place in the table - for a
+    function, the one with the body. */
+    struct yf_parse_node ** decls;
+
+    /* Entries found reachable whose declarations haven't been searched. */
+    unsigned long * stack;
+    unsigned long depth;
+
+};
+
+static void index_reach_entry(
+    struct yfs_symbol_index * index, struct index_reach * reach,
+    struct yfs_index_entry * entry
+) {
+
+    const char * prefix = entry->sym->prefix;
+
+    if (entry->sym->reachable)
+        return;
+
+    entry->sym->reachable = true;
+    index->usage_hash += yf_hash_str(
+        entry->name, yf_hash_str(prefix ? prefix : "", 1)
+    );
+    reach->stack[reach->depth++] = entry - index->entries;
+
+}
+
+/**
+ * Whatever a reachable declaration uses is reachable too. A local that shadows
+ * a global makes the global look used - that only keeps too much.
+ */
+static void index_visit_reachable(
+    struct yfs_symbol_index * index, unsigned from,
+    struct yfcs_identifier * id, void * ctx
+) {
+
+    int module = from;
+    struct yfs_index_entry * entry;
+
+    if (id->filepath[0])
+        module = yfs_index_find_module(index, id->filepath);
+    if (module == -1)
+        return;
+    if ( (entry = index_find(index, module, id->name)) )
+        index_reach_entry(index, ctx, entry);
+
+}
+
+int yfs_index_mark_reachable(
+    struct yfs_symbol_index * index, struct yf_compilation_data * pdata
+) {
+
+    struct yf_list_cursor jobs;
+    struct yf_compilation_job * job;
+    struct yf_compile_analyse_job * adata;
+    struct yf_parse_node * decl, ** slot;
+    struct yfs_index_entry * entry;
+    struct index_reach reach = { 0 };
+    const char * name;
+    unsigned long i;
+    unsigned module = 0;
+
+    if (!index->entry_point)
+        return 0;
+
+    reach.decls = yf_calloc(index->num_entries, sizeof *reach.decls);
+    reach.stack = yf_malloc(index->num_entries * sizeof *reach.stack);
+    if (!reach.decls || !reach.stack) {
+        yf_free(reach.decls);
+        yf_free(reach.stack);
+        return 3;
+    }
+
+    /* Nothing is reachable until it's found to be. */
+    for (i = 0; i < index->num_entries; ++i) {
+        if (index->entries[i].sym)
+            index->entries[i].sym->reachable = false;
+    }
+
+    /* Find the declaration of every global. The entry point is where the
+    search starts, and functions from C are always kept. */
+    YF_LIST_FOREACH_CUR(jobs, pdata->jobs, job) {
+        if (job->type != YF_COMPILATION_ANALYSE)
+            continue;
+        adata = (struct yf_compile_analyse_job *) job;
+        if (!adata->symtab.table.buckets)
+            continue;
+        YF_VEC_FOREACH(adata->parse_tree.program.decls, decl) {
+            if (decl->type == YFCS_FUNCDECL)
+                name = decl->funcdecl.name.name;
+            else if (decl->type == YFCS_VARDECL)
+                name = decl->vardecl.name.name;
+            else
+                continue;
+            if (!(entry = index_find(index, module, name)))
+                continue;
+            /* A function may be declared again without a body, before or
+            after it's defined - what it uses is in the body. */
+            slot = &reach.decls[entry - index->entries];
+            if (!*slot || decl->type != YFCS_FUNCDECL || decl->funcdecl.body)
+                *slot = decl;
+            if (entry->sym == index->entry_point
+                || (decl->type == YFCS_FUNCDECL && decl->funcdecl.extc))
+                index_reach_entry(index, &reach, entry);
+        }
+        ++module;
+    }
+
+    while (reach.depth) {
+        i = reach.stack[--reach.depth];
+        index_walk(
+            index, index->entries[i].module, reach.decls[i],
+            index_visit_reachable, &reach
+        );
+    }
+
+    yf_free(reach.decls);
+    yf_free(reach.stack);
+    return 0;
+
+}
+
+void yfs_destroy_symbol_index(struct yfs_symbol_index * index) {
+
+    yf_free(index->modules);
+    yf_free(index->entries);
+    if (index->module_map.buckets)
+        yfh_destroy(&index->module_map, NULL);
+    yf_intern_destroy(&index->names);
+
+}
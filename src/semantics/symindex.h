@@ -0,0 +1,52 @@
+/**
+ * The project-wide symbol index - see struct yfs_symbol_index.
+ */
+
+#ifndef SEMANTICS_SYMINDEX_H
+#define SEMANTICS_SYMINDEX_H
+
+#include <api/compilation-data.h>
+
+/**
+ * Index the symbol tables of all analysed units in the compilation, and mark
+ * the globals that some unit uses from another as exported - each unit's
+ * imports list the ones it uses. This must run
+ * after all analysis jobs, and before any validation - it reads every unit's
+ * parse tree.
+ * 0 - success, 3 - memory error
+ */
+int yfs_build_symbol_index(
+    struct yfs_symbol_index *, struct yf_compilation_data *
+);
+
+/**
+ * Find the module ID for an identifier prefix, like path.to.foo. Returns -1 if
+ * there is no such module.
+ */
+int yfs_index_find_module(struct yfs_symbol_index *, const char * prefix);
+
+/**
+ * Find a global symbol of a module. Returns NULL if it doesn't exist.
+ */
+struct yf_sym * yfs_index_lookup(
+    struct yfs_symbol_index *, unsigned module, const char * name
+);
+
+/**
+ * Find the globals that can be reached from the entry point, following every
+ * use of a global in a declaration that is reachable - functions from C are
+ * always reachable. Only the ones found are left marked reachable. Does
+ * nothing if there's no single entry point. Like building the index, this
+ * reads every unit's parse tree.
+ * 0 - success, 3 - memory error
+ */
+int yfs_index_mark_reachable(
+    struct yfs_symbol_index *, struct yf_compilation_data *
+);
+
+/**
+ * Free the index. The symbols themselves are owned by their symbol tables.
+ */
+void yfs_destroy_symbol_index(struct yfs_symbol_index *);
+
+#endif /* SEMANTICS_SYMINDEX_H */
@@ -1,11 +1,13 @@
 #include "symtab.h"
 
 #include <api/sym.h>
+#include <semantics/types.h>
 #include <util/allocator.h>
+#include <util/hash.h>
 #include <util/yfc-out.h>
 
-static int yfs_add_var(struct yf_hashmap * symtab, struct yf_parse_node *);
-static int yfs_add_fn(struct yf_hashmap * symtab, struct yf_parse_node *);
+static int yfs_add_var(struct yf_compile_analyse_job *, struct yf_parse_node *);
+static int yfs_add_fn(struct yf_compile_analyse_job *, struct yf_parse_node *);
 
 int yfs_build_symtab(struct yf_compile_analyse_job * data) {
 
@@ -14,20 +16,21 @@ int yfs_build_symtab(struct yf_compile_analyse_job * data) {
 
     yfh_init(&data->symtab.table);
     data->symtab.parent = NULL;
-    if (!data->symtab.table.buckets) {
+    data->symtab.filter = 0;
+    if (!data->symtab.table.buckets || yf_intern_init(&data->strings)) {
         YF_PRINT_ERROR("symtab: failed to allocate table");
         return 3; /* Memory error */
     }
     
     ret = 0;
-    YF_LIST_FOREACH(data->parse_tree.program.decls, node) {
+    YF_VEC_FOREACH(data->parse_tree.program.decls, node) {
         switch (node->type) {
             case YFCS_VARDECL:
-                if (yfs_add_var(&data->symtab.table, node))
+                if (yfs_add_var(data, node))
                     ret = 1;
                 break;
             case YFCS_FUNCDECL:
-                if (yfs_add_fn(&data->symtab.table, node))
+                if (yfs_add_fn(data, node))
                     ret = 1;
                 break;
             default:
@@ -40,8 +43,11 @@ int yfs_build_symtab(struct yf_compile_analyse_job * data) {
 
 }
 
-static int yfs_add_var(struct yf_hashmap * symtab, struct yf_parse_node * n) {
+static int yfs_add_var(
+    struct yf_compile_analyse_job * data, struct yf_parse_node * n
+) {
 
+    struct yfs_symtab * symtab = &data->symtab;
     struct yfcs_vardecl * v = &n->vardecl;
     struct yf_sym * vsym, * dupl;
     vsym = yf_malloc(sizeof (struct yf_sym));
@@ -50,26 +56,38 @@ static int yfs_add_var(struct yf_hashmap * symtab, struct yf_parse_node * n) {
     vsym->type = YFS_VAR;
     
     vsym->loc = n->loc;
+    vsym->prefix = data->unit_info->file_prefix;
+    vsym->exported = false;
+    vsym->reachable = true;
     
-    vsym->var.name = v->name.name;
+    vsym->var.name = yf_intern(&data->strings, v->name.name);
+    if (!vsym->var.name) {
+        yf_free(vsym);
+        return 3;
+    }
+    /* Resolved now so other units can use it before this one is validated. */
+    vsym->var.dtype = yfs_get_builtin_type(v->type.databuf);
 
-    if (yfh_get(symtab, vsym->var.name, (void **)&dupl) == 0) {
+    if (yfh_get(&symtab->table, vsym->var.name, (void **)&dupl) == 0) {
         YF_PRINT_ERROR(
             "symtab: duplicate variable declaration '%s' (lines %d and %d)",
             v->name.name, dupl->loc.line, vsym->loc.line
         );
-        free(vsym);
+        yf_free(vsym);
         return 1;
     }
 
-    yfh_set(symtab, v->name.name, vsym);
+    yfs_symtab_add(symtab, vsym->var.name, vsym);
 
     return 0;
 
 }
 
-static int yfs_add_fn(struct yf_hashmap * symtab, struct yf_parse_node * f) {
-    
+static int yfs_add_fn(
+    struct yf_compile_analyse_job * data, struct yf_parse_node * f
+) {
+
+    struct yfs_symtab * symtab = &data->symtab;
     struct yfcs_funcdecl * fn = &f->funcdecl;
 
     struct yf_sym * fsym;
@@ -83,27 +101,104 @@ static int yfs_add_fn(struct yf_hashmap * symtab, struct yf_parse_node * f) {
 
     fsym->type = YFS_FN;
     fsym->loc = f->loc;
+    fsym->prefix = data->unit_info->file_prefix;
+    fsym->exported = false;
+    fsym->reachable = true;
 
-    fsym->fn.name = fn->name.name;
+    fsym->fn.name = yf_intern(&data->strings, fn->name.name);
+    if (!fsym->fn.name) {
+        yf_free(fsym);
+        return 3;
+    }
+    /* Resolved now so other units can call it before this one is validated. */
+    fsym->fn.rtype = yfs_get_builtin_type(fn->ret.databuf);
 
-    yf_list_init(&fsym->fn.params);
+    yf_vec_init(&fsym->fn.params);
 
     /* Adding parameters to symbol */
-    YF_LIST_FOREACH(fn->params, narg) {
+    YF_VEC_FOREACH(fn->params, narg) {
 
         arg = &narg->vardecl;
         
         param = yf_malloc(sizeof (struct yfsn_param));
         if (!param) return 3;
 
-        param->name = arg->name.name;
-        param->type = arg->type.databuf;
-        yf_list_add(&fsym->fn.params, param);
+        param->name = yf_intern(&data->strings, arg->name.name);
+        param->type = yf_intern(&data->strings, arg->type.databuf);
+        if (!param->name || !param->type)
+            return 3;
+        param->dtype = yfs_get_builtin_type(param->type);
+        yf_vec_add(&fsym->fn.params, param);
 
     }
 
-    yfh_set(symtab, fsym->fn.name, fsym);
+    yfs_symtab_add(symtab, fsym->fn.name, fsym);
 
     return 0;
 
 }
+
+uint64_t yfs_symtab_filter_bits(const char * name) {
+
+    /* FNV-1a, then two bits from different parts of the hash. */
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *name; ++name) {
+        hash ^= (unsigned char) *name;
+        hash *= 1099511628211ULL;
+    }
+
+    return ((uint64_t) 1 << (hash & 63)) | ((uint64_t) 1 << ((hash >> 32) & 63));
+
+}
+
+int yfs_symtab_add(
+    struct yfs_symtab * symtab, const char * name, struct yf_sym * sym
+) {
+    symtab->filter |= yfs_symtab_filter_bits(name);
+    return yfh_set(&symtab->table, name, sym);
+}
+
+/**
+ * Internal - hash one global symbol: its kind, name, and types.
+ */
+static uint64_t yfs_sym_hash(const char * name, struct yf_sym * sym) {
+
+    struct yfsn_param * param;
+    uint64_t hash = yf_hash_str(name, sym->type);
+
+    switch (sym->type) {
+        case YFS_VAR:
+            if (sym->var.dtype)
+                hash = yf_hash_str(sym->var.dtype->name, hash);
+            break;
+        case YFS_FN:
+            if (sym->fn.rtype)
+                hash = yf_hash_str(sym->fn.rtype->name, hash);
+            YF_VEC_FOREACH(sym->fn.params, param) {
+                hash = yf_hash_str(param->name, hash);
+                hash = yf_hash_str(param->type, hash);
+            }
+            break;
+    }
+
+    return hash;
+
+}
+
+uint64_t yfs_symtab_interface_hash(struct yfs_symtab * symtab) {
+
+    struct yfh_cursor cursor;
+    const char * name;
+    struct yf_sym * sym;
+    uint64_t hash = 0;
+
+    /* Summed, since the order of a hashmap means nothing. */
+    for (yfh_cursor_init(&cursor, &symtab->table); !yfh_cursor_next(&cursor); ) {
+        yfh_cursor_get(&cursor, &name, (void **) &sym);
+        hash += yfs_sym_hash(name, sym);
+    }
+
+    return hash;
+
+}
@@ -12,4 +12,24 @@
  */
 int yfs_build_symtab(struct yf_compile_analyse_job *);
 
+/**
+ * The filter bits of a name - a scope may contain the name only if all of them
+ * are set in its filter.
+ */
+uint64_t yfs_symtab_filter_bits(const char * name);
+
+/**
+ * Add a symbol to a scope. All insertions must go through this, so that the
+ * scope filter stays correct. Returns 1 on failure.
+ */
+int yfs_symtab_add(
+    struct yfs_symtab *, const char * name, struct yf_sym *
+);
+
+/**
+ * A hash of every global symbol of a unit - what other units can see of it. Two
+ * symbol tables with the same names and types hash the same.
+ */
+uint64_t yfs_symtab_interface_hash(struct yfs_symtab *);
+
 #endif /* SEMANTICS_SYMTAB_H */
@@ -1,10 +1,90 @@
 #include "types.h"
 
-enum yfs_conversion_allowedness yfs_is_safe_conversion(
-    struct yfs_type * from, struct yfs_type * to
+#include <string.h>
+
+const struct yfs_type yfs_builtin_types[YFS_B_COUNT] = {
+#define YFS_BUILTIN_ENTRY(id, tname, size, fmt, ctx) \
+    [YFS_B_ ## id] = { \
+        .primitive = { size, fmt }, \
+        .kind      = YFS_T_PRIMITIVE, \
+        .name      = #tname, \
+        .builtin   = YFS_B_ ## id, \
+        .cname     = YFS_C_SPELLING(size, fmt), \
+    },
+    YFS_BUILTIN_TYPES(YFS_BUILTIN_ENTRY, )
+#undef YFS_BUILTIN_ENTRY
+};
+
+#define YFS_BUILTIN_HANDLE(id, name, size, fmt, ctx) \
+    const struct yfs_type * const yfs_builtin_ ## name = \
+        &yfs_builtin_types[YFS_B_ ## id];
+YFS_BUILTIN_TYPES(YFS_BUILTIN_HANDLE, )
+#undef YFS_BUILTIN_HANDLE
+
+const struct yfs_type * yfs_get_builtin_type(const char * name) {
+
+    const struct yfs_type * type;
+
+    /* Slot 0 is YFS_B_NONE, which is not a type. */
+    for (type = yfs_builtin_types + 1;
+        type < yfs_builtin_types + YFS_B_COUNT; ++type
+    ) {
+        if (strcmp(type->name, name) == 0) {
+            return type;
+        }
+    }
+
+    return NULL;
+
+}
+
+/**
+ * The conversion rule between two primitive types, given their sizes and
+ * formats. This has to stay a constant expression, since it's used to build the
+ * conversion table below.
+ */
+#define YFS_CONVERSION_RULE(fsize, ffmt, tsize, tfmt) ( \
+    ((fsize) == 0 || (tsize) == 0)          ? YFS_CONVERSION_VOID  : \
+    ((fsize) > (tsize) || (ffmt) != (tfmt)) ? YFS_CONVERSION_LOSSY : \
+                                              YFS_CONVERSION_OK      \
+)
+
+/**
+ * The conversion table is built by expanding the builtin list once per row. The
+ * inner expansion has to be deferred until the outer one is done, since a macro
+ * can't be expanded from inside itself.
+ */
+#define YFS_PP_EMPTY()
+#define YFS_PP_DEFER(m) m YFS_PP_EMPTY()
+#define YFS_PP_EXPAND(...) __VA_ARGS__
+#define YFS_PP_UNPACK(a, b) a, b
+#define YFS_BUILTIN_TYPES_INDIRECT() YFS_BUILTIN_TYPES
+#define YFS_CONVERSION_RULE_I(...) YFS_CONVERSION_RULE(__VA_ARGS__)
+
+#define YFS_CONVERSION_CELL(id, name, size, fmt, from) \
+    [YFS_B_ ## id] = YFS_CONVERSION_RULE_I( \
+        YFS_PP_UNPACK from, size, fmt \
+    ),
+#define YFS_CONVERSION_ROW(id, name, size, fmt, ctx) \
+    [YFS_B_ ## id] = { \
+        YFS_PP_DEFER(YFS_BUILTIN_TYPES_INDIRECT)()( \
+            YFS_CONVERSION_CELL, (size, fmt) \
+        ) \
+    },
+
+/**
+ * Indexed by [from][to]. The YFS_B_NONE row and column are never read - user
+ * types go through the slow path.
+ */
+static const unsigned char yfs_conversions[YFS_B_COUNT][YFS_B_COUNT] = {
+    YFS_PP_EXPAND(YFS_BUILTIN_TYPES(YFS_CONVERSION_ROW, ))
+};
+
+static enum yfs_conversion_allowedness yfs_is_safe_conversion_slow(
+    const struct yfs_type * from, const struct yfs_type * to
 ) {
 
-    struct yfs_primitive_type * f, * t;
+    const struct yfs_primitive_type * f, * t;
 
     /* TODO - get user-defined conversion operators (should they exist) */
     if (from->kind != to->kind) {
@@ -20,14 +100,18 @@ enum yfs_conversion_allowedness yfs_is_safe_conversion(
     f = &from->primitive;
     t = &to->primitive;
 
-    if (f->size == 0 || t->size == 0)
-        return YFS_CONVERSION_VOID;
+    return YFS_CONVERSION_RULE(f->size, f->type, t->size, t->type);
 
-    if (f->size > t->size || f->type != t->type) {
-        return YFS_CONVERSION_LOSSY;
-    }
+}
+
+enum yfs_conversion_allowedness yfs_is_safe_conversion(
+    const struct yfs_type * from, const struct yfs_type * to
+) {
+
+    if (from->builtin != YFS_B_NONE && to->builtin != YFS_B_NONE)
+        return yfs_conversions[from->builtin][to->builtin];
 
-    return YFS_CONVERSION_OK;
+    return yfs_is_safe_conversion_slow(from, to);
 
 }
 
@@ -41,14 +125,14 @@ const char * yfse_get_error_message(enum yfs_conversion_allowedness err) {
     return errs[err];
 }
 
-struct yfs_type * yfse_get_expr_type(
+const struct yfs_type * yfse_get_expr_type(
     struct yfa_expr * expr, struct yf_compile_analyse_job * fdata
 ) {
 
     /* This function is super hacky and whatnot. */
 
     int lsize, rsize;
-    struct yfs_type * ltype, * rtype;
+    const struct yfs_type * ltype, * rtype;
     struct yfa_value * v;
 
     switch (expr->type) {
@@ -60,7 +144,7 @@ struct yfs_type * yfse_get_expr_type(
         rsize = rtype->primitive.size;
 
         if (yfo_is_bool(expr->as.binary.op)) {
-            return yfv_get_type_s(fdata, "bool");
+            return yfs_builtin_bool;
         }
 
         if (yfo_is_assign(expr->as.binary.op)) {
@@ -83,9 +167,9 @@ struct yfs_type * yfse_get_expr_type(
         } else {
             switch (v->as.literal.type) {
             case YFA_L_NUM:
-                return yfv_get_type_s(fdata, "int");
+                return yfs_builtin_int;
             case YFA_L_BOOL:
-                return yfv_get_type_s(fdata, "bool");
+                return yfs_builtin_bool;
             default:
                 YF_PRINT_ERROR("panic: Unknown literal type");
                 return NULL;
@@ -99,8 +183,8 @@ struct yfs_type * yfse_get_expr_type(
 }
 
 int yfs_output_diagnostics(
-    struct yfs_type * from,
-    struct yfs_type * to,
+    const struct yfs_type * from,
+    const struct yfs_type * to,
     struct yf_compile_analyse_job * fdata,
     struct yf_location * loc
 ) {
@@ -11,6 +11,25 @@
 #include <api/loc.h>
 #include <semantics/validate/validate-internal.h>
 
+/**
+ * The builtin types, indexed by builtin ID. This is initialized at compile time
+ * and shared by every unit, so it is safe to read from any thread.
+ */
+extern const struct yfs_type yfs_builtin_types[YFS_B_COUNT];
+
+/**
+ * Direct handles to the builtin types - yfs_builtin_int, yfs_builtin_bool, etc.
+ */
+#define YFS_BUILTIN_HANDLE(id, name, size, fmt, ctx) \
+    extern const struct yfs_type * const yfs_builtin_ ## name;
+YFS_BUILTIN_TYPES(YFS_BUILTIN_HANDLE, )
+#undef YFS_BUILTIN_HANDLE
+
+/**
+ * Find a builtin type by name. Return NULL if there is no such builtin type.
+ */
+const struct yfs_type * yfs_get_builtin_type(const char * name);
+
 enum yfs_conversion_allowedness {
     YFS_CONVERSION_OK,
     YFS_CONVERSION_LOSSY, /* like i64 -> bool */
@@ -20,15 +39,15 @@ enum yfs_conversion_allowedness {
 
 /**
  * Whether the first type can be converted to the second without any possible
- * information loss.
+ * information loss. Between two builtin types, this is a single table lookup.
  */
 enum yfs_conversion_allowedness yfs_is_safe_conversion(
-    struct yfs_type * from, struct yfs_type * to
+    const struct yfs_type * from, const struct yfs_type * to
 );
 
 const char * yfse_get_error_message(enum yfs_conversion_allowedness err);
 
-struct yfs_type * yfse_get_expr_type(
+const struct yfs_type * yfse_get_expr_type(
     struct yfa_expr * expr, struct yf_compile_analyse_job * udata
 );
 
@@ -37,7 +56,7 @@ struct yfs_type * yfse_get_expr_type(
  * Return: 0 if OK / warning, 1 if error.
  */
 int yfs_output_diagnostics(
-    struct yfs_type *, struct yfs_type *, struct yf_compile_analyse_job *,
+    const struct yfs_type *, const struct yfs_type *, struct yf_compile_analyse_job *,
     struct yf_location * loc
 );
 
@@ -4,23 +4,22 @@
 int validate_if(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type,
+    const struct yfs_type * type,
     int * returns
 ) {
 
     struct yfcs_if * c = &cin->ifstmt;
     struct yfa_if  * a = &ain->ifstmt;
     int if_always_returns = 0, else_always_returns = 0;
-    struct yfs_type * t;
+    const struct yfs_type * t;
 
     ain->type = YFA_IF;
 
-    a->cond = yf_malloc(sizeof (struct yf_ast_node));
+    /* The condition and the code are allocated together. */
+    a->cond = yfv_alloc(validator, 2 * sizeof (struct yf_ast_node));
     if (!a->cond)
         return 2;
-    a->code = yf_malloc(sizeof (struct yf_ast_node));
-    if (!a->code)
-        return 2;
+    a->code = a->cond + 1;
 
     if (validate_expr(validator, c->cond, a->cond)) {
         validator->error = 1;
@@ -29,7 +28,7 @@ int validate_if(
     
     if ( (t = yfse_get_expr_type(
         &a->cond->expr, validator->udata
-    )) != yfv_get_type_s(validator->udata, "bool")) {
+    )) != yfs_builtin_bool) {
         YF_PRINT_ERROR(
             "%s %d: %d: if condition must be of type bool, was %s",
             cin->loc.file, cin->loc.line, cin->loc.column,
@@ -45,13 +44,11 @@ int validate_if(
         type, &if_always_returns
     )) {
         validator->error = 1;
-        yf_free(a->code);
-        a->code = NULL;
         return 1;
     }
 
     if (c->elsebranch) {
-        a->elsebranch = yf_malloc(sizeof (struct yf_ast_node));
+        a->elsebranch = yfv_alloc(validator, sizeof (struct yf_ast_node));
         if (!a->elsebranch)
             return 2;
         if (validate_node(
@@ -3,7 +3,7 @@
 #include <ctype.h>
 #include <string.h>
 
-#include <util/list.h>
+#include <util/vec.h>
 #include <api/abstract-tree.h>
 #include <semantics/types.h>
 
@@ -116,24 +116,20 @@ static int validate_binary(
 
     a->op = c->op;
 
-    a->left = yf_malloc(sizeof (struct yf_ast_node));
+    a->left = yfv_alloc(validator, 2 * sizeof (struct yfa_expr));
     if (!a->left)
         return 2;
+    a->right = a->left + 1;
+
     if (validate_expr_e(
         validator, &c->left->expr, a->left, loc
     )) {
-        free(a->left);
         return 1;
     }
 
-    a->right = yf_malloc(sizeof (struct yf_ast_node));
-    if (!a->right)
-        return 2;
     if (validate_expr_e(
         validator, &c->right->expr, a->right, loc
     )) {
-        free(a->right);
-        a->right = NULL;
         return 1;
     }
 
@@ -159,15 +155,12 @@ static int validate_funccall(
 ) {
 
 
-    struct yf_parse_node * carg;
-    struct yf_ast_node   * aarg;
-    struct yfsn_param    * param;
-    struct yfs_type      * paramtype;
-
-    struct yf_list_cursor param_cursor;
-    struct yf_list_cursor arg_cursor;
+    struct yf_parse_node        * carg;
+    struct yf_ast_node          * aarg;
+    struct yfsn_param           * param;
+    const struct yfs_type       * paramtype;
 
-    int lgres;
+    size_t num_args, num_params;
 
     /* Make sure the function exists. */
     if (find_symbol(
@@ -195,46 +188,41 @@ static int validate_funccall(
         return 1;
     }
 
-    /* Go through the arguments and add them to the list, while making sure
-        * the types are compatible for each one and the number of arguments
-        * matches.
+    /* Make sure the number of arguments matches. */
+    num_args = yf_vec_count(&c->args);
+    num_params = yf_vec_count(&a->name->fn.params);
+    if (num_args != num_params) {
+        YF_PRINT_ERROR(
+            "%s %d:%d: too %s arguments in function call",
+            loc->file,
+            loc->line,
+            loc->column,
+            num_args < num_params ? "few" : "many"
+        );
+        return 1;
+    }
+
+    /* Go through the arguments and add them to the array, while making sure
+        * the types are compatible for each one.
         */
-    yf_list_init(&a->args);
-    yf_list_reset_cursor(&param_cursor, &a->name->fn.params);
-    yf_list_reset_cursor(&arg_cursor, &c->args);
-    for (;;) {
-
-        aarg = yf_malloc(sizeof (struct yf_ast_node));
-        if (!aarg)
-            return 2;
-
-        if (
-            yf_list_get(&param_cursor, (void **) &param) !=
-            (lgres = yf_list_get(&arg_cursor, (void **) &carg))
-        ) {
-            YF_PRINT_ERROR(
-                "%s %d:%d: too %s arguments in function call",
-                loc->file,
-                loc->line,
-                loc->column,
-                lgres ? "few" : "many"
-            );
-            yf_free(aarg);
-            return 1;
-        }
-        if (lgres == -1) {
-            yf_free(aarg);
-            break;
-        }
+    a->num_args = 0;
+    a->args = yfv_alloc(validator, num_args * sizeof (struct yf_ast_node));
+    if (!a->args)
+        return 2;
+    for (; a->num_args < num_args; ++a->num_args) {
+
+        carg = yf_vec_get(&c->args, a->num_args);
+        param = yf_vec_get(&a->name->fn.params, a->num_args);
+        aarg = &a->args[a->num_args];
 
         if (validate_expr(
             validator, carg, aarg
         )) {
-            yf_free(aarg);
             return 1;
         }
 
-        if ( (paramtype =
+        /* Builtin parameter types were resolved with the symbol table. */
+        if ( (paramtype = param->dtype) == NULL && (paramtype =
             yfv_get_type_s(validator->udata, param->type)
         ) == NULL) {
             YF_PRINT_ERROR(
@@ -256,10 +244,6 @@ static int validate_funccall(
             return 1;
         }
 
-        yf_list_add(&a->args, aarg);
-        yf_list_next(&arg_cursor);
-        yf_list_next(&param_cursor);
-
     }
 
     return 0;
@@ -275,6 +259,8 @@ static int validate_expr_e(
     struct yf_location * loc
 ) {
     
+    ++validator->udata->profile.nodes;
+
     /* If this is unary - (just a value), ... */
     switch (c->type) {
 
@@ -8,7 +8,6 @@ int validate_funcdecl(
     struct yfcs_funcdecl  * c = &cin->funcdecl;
     struct yfa_funcdecl   * a = &ain->funcdecl;
     struct yf_parse_node  * cv;
-    struct yf_ast_node    * av;
 
     int ssym;
     int returns;
@@ -41,42 +40,32 @@ int validate_funcdecl(
     enter_scope(validator, &a->param_scope);
 
     /* Add the arguments to the scope. */
-    yf_list_init(&a->params);
-    YF_LIST_FOREACH(c->params, cv) {
-        av = yf_malloc(sizeof (struct yf_ast_node));
-        if (!av)
-            return 2;
-        if (validate_vardecl(validator, cv, av)) {
-            yf_free(av);
+    a->num_params = 0;
+    a->params = yfv_alloc(
+        validator,
+        yf_vec_count(&c->params) * sizeof (struct yf_ast_node)
+    );
+    if (!a->params)
+        return 2;
+    YF_VEC_FOREACH(c->params, cv) {
+        if (validate_vardecl(validator, cv, &a->params[a->num_params])) {
             validator->error = 1;
             return 1;
         }
-        yf_list_add(&a->params, av);
-    }
-
-    /* Validate the return type. */
-    if ((a->ret = yfv_get_type_t(validator->udata, c->ret)) == NULL) {
-        YF_PRINT_ERROR(
-            "%s %d:%d: Unknown return type '%s' of function '%s'",
-            cin->loc.file,
-            cin->loc.line,
-            cin->loc.column,
-            c->ret.databuf,
-            c->name.name
-        );
-        return 1;
+        ++a->num_params;
     }
 
     if (c->body == NULL) {
         a->body = NULL;
     } else {
-        a->body = yf_malloc(sizeof (struct yf_ast_node));
+        a->body = yfv_alloc(validator, sizeof (struct yf_ast_node));
         if (!a->body)
             return 2;
 
         /* Now, validate the body. */
-        if (validate_bstmt(validator, c->body, a->body, a->ret, &returns)) {
-            yf_free(a->body);
+        if (validate_bstmt(
+            validator, c->body, a->body, a->name->fn.rtype, &returns
+        )) {
             a->body = NULL;
             return 1;
         }
@@ -87,7 +76,7 @@ int validate_funcdecl(
     exit_scope(validator);
 
     if (a->body != NULL) {
-        if (returns == 0 && a->ret->primitive.size != 0) {
+        if (returns == 0 && a->name->fn.rtype->primitive.size != 0) {
             YF_PRINT_ERROR(
                 "%s %d:%d: Function '%s' does not always return a value",
                 cin->loc.file,
@@ -113,7 +102,7 @@ int validate_funcdecl(
 int validate_bstmt(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type,
+    const struct yfs_type * type,
     int * returns
 ) {
 
@@ -130,12 +119,18 @@ int validate_bstmt(
     /* Create a symbol table for this scope */
     enter_scope(validator, &a->symtab);
 
-    /* Validate each statement */
-    yf_list_init(&a->stmts);
+    /* Validate each statement, in place. */
+    a->num_stmts = 0;
+    a->stmts = yfv_alloc(
+        validator,
+        yf_vec_count(&c->stmts) * sizeof (struct yf_ast_node)
+    );
+    if (!a->stmts)
+        return 2;
 
     *returns = 0;
 
-    YF_LIST_FOREACH(c->stmts, csub) {
+    YF_VEC_FOREACH(c->stmts, csub) {
 
         /* If this comes after a return, none of it will be executed. */
         if (*returns && !ret_warning_reported) {
@@ -148,20 +143,14 @@ int validate_bstmt(
             );
         }
         
-        /* Construct abstract instance */
-        asub = yf_malloc(sizeof (struct yf_ast_node));
-        if (!asub)
-            return 2;
-
-        /* Validate */
+        /* Validate - a statement that fails is overwritten by the next. */
+        asub = &a->stmts[a->num_stmts];
         if (validate_node(validator, csub, asub, type, returns)) {
-            yf_free(asub);
             validator->error = 1;
             err = 1;
         } else {
 
-            /* Move to abstract list */
-            yf_list_add(&a->stmts, asub);
+            ++a->num_stmts;
 
             /* Probably redundant */
             if (asub->type == YFA_RETURN) {
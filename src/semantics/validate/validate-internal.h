@@ -32,6 +32,12 @@ int find_symbol(
     struct yfcs_identifier * name
 );
 
+/**
+ * Allocate memory for the AST being built. It's owned by the tree, and freed
+ * with it - never free it on its own. Returns NULL only if memory runs out.
+ */
+void * yfv_alloc(struct yfv_validator * v, size_t size);
+
 /**
  * Create a new scope - return 0 on success, 1 on failure (memory error).
  * The root of the created symtab is set to the current scope, and the current
@@ -62,7 +68,7 @@ VDECL(validate_vardecl);
 int validate_node(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type, int * returns
+    const struct yfs_type * type, int * returns
 );
 
 /**
@@ -71,7 +77,7 @@ int validate_node(
 int validate_return(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type, int * returns
+    const struct yfs_type * type, int * returns
 );
 /**
  * For block statements, we need to reason about what they return.
@@ -80,19 +86,19 @@ int validate_return(
 int validate_bstmt(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type,
+    const struct yfs_type * type,
     int * returns
 );
 
 int validate_if(
     struct yfv_validator * validator,
     struct yf_parse_node * cin, struct yf_ast_node * ain,
-    struct yfs_type * type,
+    const struct yfs_type * type,
     int * returns
 );
 
 /**
- * Add a type to a file's type table.
+ * Add a user-defined type to a file's type table.
  */
 int yfv_add_type(
     struct yf_compile_analyse_job * udata,
@@ -100,9 +106,10 @@ int yfv_add_type(
 );
 
 /**
- * Get a type from a file's type table, given a concrete type.
+ * Get a type from a file's type table, given a concrete type. Builtin types are
+ * always found, without touching the file's type table.
  */
-struct yfs_type * yfv_get_type_t(
+const struct yfs_type * yfv_get_type_t(
     struct yf_compile_analyse_job * udata,
     struct yfcs_type type
 );
@@ -110,9 +117,9 @@ struct yfs_type * yfv_get_type_t(
 /**
  * Get a type from a file's type table, given a string.
  */
-struct yfs_type * yfv_get_type_s(
+const struct yfs_type * yfv_get_type_s(
     struct yf_compile_analyse_job * udata,
-    char * typestr
+    const char * typestr
 );
 
 #endif /* SEMANTICS_VALIDATE_UTILS_H */
@@ -1,5 +1,9 @@
 #include <semantics/validate/validate-internal.h>
 
+#include <semantics/symindex.h>
+#include <semantics/symtab.h>
+#include <semantics/types.h>
+
 #include <string.h>
 
 #include <util/yfc-out.h>
@@ -18,12 +22,20 @@
 static int find_symbol_from_scope(
     struct yfs_symtab * symtab,
     struct yf_sym ** sym,
-    char * name
+    char * name,
+    struct yfs_lookup_stats * stats
 ) {
     int depth = 0;
+    uint64_t bits = yfs_symtab_filter_bits(name);
     while (symtab != NULL) {
-        if (yfh_get(&symtab->table, name, (void **)sym) == 0) {
-            return depth;
+        /* Only search the scope if the filter says the name might be in it. */
+        if ((symtab->filter & bits) != bits) {
+            ++stats->skipped;
+        } else {
+            ++stats->probes;
+            if (yfh_get(&symtab->table, name, (void **)sym) == 0) {
+                return depth;
+            }
         }
         depth++;
         symtab = symtab->parent;
@@ -32,8 +44,8 @@ static int find_symbol_from_scope(
 }
 
 /**
- * If the identifier has no prefix, search the current file. Otherwise, look up
- * the loaded file.
+ * If the identifier has no prefix, search the current file. Otherwise, look it
+ * up in the project's symbol index. Misses are reported by the caller.
  */
 int find_symbol(
     struct yfv_validator * validator,
@@ -44,40 +56,45 @@ int find_symbol(
         return find_symbol_from_scope(
             validator->current_scope,
             sym,
-            name->name
+            name->name,
+            &validator->udata->lookups
         );
     } else {
-        struct yfs_symtab * symtab;
-        if (yfh_get(
-            &validator->pdata->symtables, name->filepath, (void **)&symtab
-        )) {
-            YF_PRINT_ERROR("Could not find module: %s", name->filepath);
+        struct yfs_symbol_index * index = &validator->pdata->symindex;
+        int module = yfs_index_find_module(index, name->filepath);
+        if (module == -1)
             return -1;
-        }
-        return find_symbol_from_scope(
-            symtab,
-            sym,
-            name->name
-        );
+        if ( (*sym = yfs_index_lookup(index, module, name->name)) == NULL)
+            return -1;
+        /* Other modules are only ever searched at the global scope. */
+        return 0;
     }
 }
 
+void * yfv_alloc(struct yfv_validator * v, size_t size) {
+    return yf_arena_alloc(&v->udata->ast_tree.arena, size);
+}
+
 int enter_scope(struct yfv_validator * v, struct yfs_symtab ** stuff) {
 
     struct yfs_symtab * old_symtab, * new_symtab;
     old_symtab = v->current_scope;
 
-    new_symtab = yf_malloc(sizeof (struct yfs_symtab));
+    new_symtab = yfv_alloc(v, sizeof (struct yfs_symtab));
     if (!new_symtab) {
         return 1;
     }
     yfh_init(&new_symtab->table);
     if (!new_symtab->table.buckets) {
-        free(new_symtab);
+        return 1;
+    }
+    if (yf_vec_add(&v->udata->ast_tree.scopes, new_symtab)) {
+        yfh_destroy(&new_symtab->table, NULL);
         return 1;
     }
 
     new_symtab->parent = old_symtab;
+    new_symtab->filter = 0;
     v->current_scope = new_symtab;
 
     if (stuff)
@@ -97,12 +114,18 @@ int yfv_add_type(
     struct yfs_type * type
 ) {
     /**
-     * Set a value in the hashmap.
+     * Set a value in the hashmap. The table is only created once a unit
+     * actually defines a type.
      */
+    if (!udata->types.table.buckets) {
+        yfh_init(&udata->types.table);
+        if (!udata->types.table.buckets)
+            return 1;
+    }
     return yfh_set(&udata->types.table, type->name, type);
 }
 
-struct yfs_type * yfv_get_type_t(
+const struct yfs_type * yfv_get_type_t(
     struct yf_compile_analyse_job * udata,
     struct yfcs_type type
 ) {
@@ -112,14 +135,20 @@ struct yfs_type * yfv_get_type_t(
     return yfv_get_type_s(udata, type.databuf);
 }
 
-struct yfs_type * yfv_get_type_s(
+const struct yfs_type * yfv_get_type_s(
     struct yf_compile_analyse_job * udata,
-    char * typestr
+    const char * typestr
 ) {
     /**
-     * Get a value from the hashmap.
+     * Builtin types first, then the user-defined ones from the hashmap.
      */
     struct yfs_type * result = NULL;
-    yfh_get(&udata->types.table, typestr, (void **)&result);
+    const struct yfs_type * builtin;
+
+    if ( (builtin = yfs_get_builtin_type(typestr)) != NULL)
+        return builtin;
+
+    if (udata->types.table.buckets)
+        yfh_get(&udata->types.table, typestr, (void **)&result);
     return result;
 }
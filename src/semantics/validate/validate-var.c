@@ -1,5 +1,6 @@
 #include <semantics/validate/validate-internal.h>
 
+#include <semantics/symtab.h>
 #include <semantics/types.h>
 
 /**
@@ -57,15 +58,20 @@ int validate_vardecl(
         return 2;
 
     a->name->type = YFS_VAR;
+    a->name->prefix = NULL;
+    a->name->exported = false;
+    a->name->reachable = true;
 
     /* Add to symbol table UNLESS it is global scope. */
     /* The global scope symtab is already set up. */
     if (!global) {
-        a->name->var.name = c->name.name;
-        yfh_set(&validator->current_scope->table, c->name.name, a->name);
+        a->name->var.name = yf_intern(&validator->udata->strings, c->name.name);
+        if (!a->name->var.name)
+            return 2;
+        yfs_symtab_add(validator->current_scope, a->name->var.name, a->name);
     } else {
         /* Free the name, since it was only needed for type checking. */
-        free(a->name);
+        yf_free(a->name);
         /* If it's global, set "name" to point to the global symbol. */
         a->name = entry;
     }
@@ -109,12 +115,10 @@ int validate_vardecl(
     a->name->loc = cin->loc;
 
     if (c->expr) {
-        a->expr = yf_malloc(sizeof (struct yf_ast_node));
+        a->expr = yfv_alloc(validator, sizeof (struct yf_ast_node));
         if (!a->expr)
             return 2;
-        a->expr->type = YFA_EXPR;
         if (validate_expr(validator, c->expr, a->expr)) {
-            free(a->expr);
             a->expr = NULL;
             return 1;
         }
@@ -1,36 +1,173 @@
 #include "allocator.h"
 
 #include <util/yfc-out.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <string.h>
 
+/**
+ * Stored right before every allocation. The union keeps the memory after it
+ * aligned for any type, just like malloc's.
+ */
+union yf_alloc_header {
+    struct {
+        size_t size;
+        enum yf_alloc_tag tag;
+    };
+    max_align_t align;
+};
+
+struct yf_alloc_stats {
+    _Atomic size_t live, peak;
+    _Atomic unsigned long allocs, frees;
+};
+
+static _Thread_local enum yf_alloc_tag yf_current_tag = YF_ALLOC_DRIVER;
+
+/* One per tag, and the last one for all of them together. */
+static struct yf_alloc_stats yf_stats[YF_ALLOC_TAG_COUNT + 1];
+
+static const char * const yf_tag_names[YF_ALLOC_TAG_COUNT] = {
+    [YF_ALLOC_DRIVER] = "driver",
+    [YF_ALLOC_LEXER]  = "lexer",
+    [YF_ALLOC_PARSER] = "parser",
+    [YF_ALLOC_SYMTAB] = "symtab",
+    [YF_ALLOC_AST]    = "ast",
+};
+
+static void yf_stats_add(struct yf_alloc_stats * stats, size_t size) {
+
+    size_t live, peak;
+
+    live = atomic_fetch_add_explicit(&stats->live, size, memory_order_relaxed)
+        + size;
+    peak = atomic_load_explicit(&stats->peak, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(
+        &stats->peak, &peak, live, memory_order_relaxed, memory_order_relaxed
+    ));
+    atomic_fetch_add_explicit(&stats->allocs, 1, memory_order_relaxed);
+
+}
+
+static void yf_stats_remove(struct yf_alloc_stats * stats, size_t size) {
+    atomic_fetch_sub_explicit(&stats->live, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->frees, 1, memory_order_relaxed);
+}
+
+/**
+ * Internal - fill in the header of a new block, and return the memory after it.
+ */
+static void * yf_alloc_track(union yf_alloc_header * header, size_t size) {
+
+    header->size = size;
+    header->tag = yf_current_tag;
+    yf_stats_add(&yf_stats[header->tag], size);
+    yf_stats_add(&yf_stats[YF_ALLOC_TAG_COUNT], size);
+    return header + 1;
+
+}
+
+static void yf_alloc_untrack(union yf_alloc_header * header) {
+    yf_stats_remove(&yf_stats[header->tag], header->size);
+    yf_stats_remove(&yf_stats[YF_ALLOC_TAG_COUNT], header->size);
+}
+
 void * yf_malloc(size_t size) {
 
-    void * ret;
-    ret = malloc(size);
+    union yf_alloc_header * ret = NULL;
+
+    if (size <= SIZE_MAX - sizeof *ret)
+        ret = malloc(sizeof *ret + size);
 
     if (ret == NULL) {
         YF_PRINT_ERROR("Allocation of %zu bytes failed", size);
+        /* Return anyway, the error will be printed out before. */
+        return NULL;
     }
 
-    /* Return anyway, the error will be printed out before. */
-    return ret;
+    return yf_alloc_track(ret, size);
 
 }
 
 void * yf_calloc(size_t num_elems, size_t size) {
 
-    void * ret;
-    ret = calloc(num_elems, size);
+    union yf_alloc_header * ret = NULL;
+
+    /* Check for overflow ourselves, since the header is added to the size. */
+    if (size == 0 || num_elems <= (SIZE_MAX - sizeof *ret) / size)
+        ret = calloc(1, sizeof *ret + num_elems * size);
 
     if (ret == NULL) {
         YF_PRINT_ERROR("Allocation of %zu %zu-byte sized elements failed", num_elems, size);
+        return NULL;
     }
 
-    return ret;
+    return yf_alloc_track(ret, num_elems * size);
+}
+
+void * yf_realloc(void * ptr, size_t size) {
+
+    union yf_alloc_header * header, * ret = NULL;
+
+    if (ptr == NULL)
+        return yf_malloc(size);
+
+    header = (union yf_alloc_header *) ptr - 1;
+
+    if (size <= SIZE_MAX - sizeof *ret)
+        ret = realloc(header, sizeof *ret + size);
+
+    if (ret == NULL) {
+        YF_PRINT_ERROR("Reallocation to %zu bytes failed", size);
+        return NULL;
+    }
+
+    /* Moved or not, the old block is gone - count the new one under the
+    current tag. */
+    yf_alloc_untrack(ret);
+    return yf_alloc_track(ret, size);
 }
 
 void yf_free(void * ptr) {
-    free(ptr);
+
+    union yf_alloc_header * header;
+
+    if (ptr == NULL)
+        return;
+
+    header = (union yf_alloc_header *) ptr - 1;
+    yf_alloc_untrack(header);
+    free(header);
+
+}
+
+enum yf_alloc_tag yf_alloc_set_tag(enum yf_alloc_tag tag) {
+    enum yf_alloc_tag prev = yf_current_tag;
+    yf_current_tag = tag;
+    return prev;
+}
+
+static void yf_alloc_report_line(
+    FILE * out, const char * name, struct yf_alloc_stats * stats
+) {
+    fprintf(out, "%-10s %12zu %12zu %12lu %12lu\n",
+        name,
+        atomic_load(&stats->live), atomic_load(&stats->peak),
+        atomic_load(&stats->allocs), atomic_load(&stats->frees)
+    );
+}
+
+void yf_alloc_report(FILE * out) {
+
+    int tag;
+
+    fprintf(out, "%-10s %12s %12s %12s %12s\n",
+        "tag", "live (B)", "peak (B)", "allocs", "frees"
+    );
+    for (tag = 0; tag < YF_ALLOC_TAG_COUNT; ++tag)
+        yf_alloc_report_line(out, yf_tag_names[tag], &yf_stats[tag]);
+    yf_alloc_report_line(out, "total", &yf_stats[YF_ALLOC_TAG_COUNT]);
+
 }
 
 /**
@@ -46,6 +183,7 @@ char * yf_strdup(const char * src) {
     char * dst;
     size_t sz = strlen(src);
     dst = yf_malloc(sz + 1);
-    memcpy(dst, src, sz + 1);
+    if (dst)
+        memcpy(dst, src, sz + 1);
     return dst;
 }
@@ -1,20 +1,48 @@
 /**
- * An allocator. Mostly a wrapper around malloc for now, but may be more
- * complicated later. This mostly exists for the purpose of printing out
- * errors.
+ * An allocator. A wrapper around malloc that prints out errors and keeps count
+ * of what is allocated. Every allocation in the compiler should go through
+ * here - memory from yf_malloc must be freed with yf_free, and never with free.
+ *
+ * Each allocation is charged to the tag that was current when it was made, so
+ * that we can see which part of the compiler holds how much memory.
  */
 
 #ifndef UTIL_ALLOCATOR_H
 #define UTIL_ALLOCATOR_H
 
 #include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+enum yf_alloc_tag {
+    YF_ALLOC_DRIVER,
+    YF_ALLOC_LEXER,
+    YF_ALLOC_PARSER,
+    YF_ALLOC_SYMTAB,
+    YF_ALLOC_AST,
+    YF_ALLOC_TAG_COUNT
+};
+
 void * yf_malloc(size_t size);
 /* Allocates an array of num_elems elements of a given size and zeroes the memory */
 void * yf_calloc(size_t num_elems, size_t size);
+/* Resizes an allocation. On failure, the old allocation is left as it was. */
+void * yf_realloc(void * ptr, size_t size);
 void yf_free(void * ptr);
 
+/**
+ * Set the tag that allocations on this thread are charged to, and return the
+ * previous one, so it can be put back. Allocations are freed from the tag they
+ * were made under, whatever the current tag is.
+ */
+enum yf_alloc_tag yf_alloc_set_tag(enum yf_alloc_tag tag);
+
+/**
+ * Print the live and peak bytes and the number of allocations of each tag,
+ * and of the whole program.
+ */
+void yf_alloc_report(FILE * out);
+
 /**
  * A version of strcpy that returns pointer to the terminating NUL-byte for faster concatenations
  */
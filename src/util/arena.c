@@ -0,0 +1,78 @@
+#include "arena.h"
+
+#include <util/allocator.h>
+
+#define YF_ARENA_ALIGN (sizeof (max_align_t))
+
+void yf_arena_init(struct yf_arena * arena) {
+    arena->current = NULL;
+    arena->used = 0;
+    arena->reserved = 0;
+}
+
+static struct yf_arena_block * yf_arena_new_block(size_t size) {
+
+    struct yf_arena_block * block;
+
+    block = yf_malloc(sizeof (struct yf_arena_block) + size);
+    if (!block)
+        return NULL;
+
+    block->size = size;
+    block->used = 0;
+    return block;
+
+}
+
+void * yf_arena_alloc(struct yf_arena * arena, size_t size) {
+
+    struct yf_arena_block * block = arena->current;
+    void * ret;
+
+    size = (size + YF_ARENA_ALIGN - 1) & ~(YF_ARENA_ALIGN - 1);
+
+    if (size > YF_ARENA_BLOCK_SIZE / 4) {
+        /* Too big to share a block - give it its own, and put it behind the
+        current one so the rest of the current block isn't wasted. */
+        if (!(block = yf_arena_new_block(size)))
+            return NULL;
+        block->used = size;
+        if (arena->current) {
+            block->prev = arena->current->prev;
+            arena->current->prev = block;
+        } else {
+            block->prev = NULL;
+            arena->current = block;
+        }
+        arena->used += size;
+        arena->reserved += size;
+        return block->data;
+    }
+
+    if (!block || block->size - block->used < size) {
+        if (!(block = yf_arena_new_block(YF_ARENA_BLOCK_SIZE)))
+            return NULL;
+        block->prev = arena->current;
+        arena->current = block;
+        arena->reserved += YF_ARENA_BLOCK_SIZE;
+    }
+
+    ret = (char *) block->data + block->used;
+    block->used += size;
+    arena->used += size;
+    return ret;
+
+}
+
+void yf_arena_destroy(struct yf_arena * arena) {
+
+    struct yf_arena_block * block, * prev;
+
+    for (block = arena->current; block; block = prev) {
+        prev = block->prev;
+        yf_free(block);
+    }
+
+    yf_arena_init(arena);
+
+}
@@ -0,0 +1,47 @@
+/**
+ * An arena allocator. Allocations are carved out of big blocks one after the
+ * other, and are never freed on their own - the whole arena is freed at once.
+ * This is for data that all dies at the same time, like the nodes of a tree.
+ */
+
+#ifndef UTIL_ARENA_H
+#define UTIL_ARENA_H
+
+#include <stddef.h>
+
+/* The usual size of a block. Larger allocations get a block of their own. */
+#define YF_ARENA_BLOCK_SIZE 0x10000
+
+struct yf_arena_block {
+    struct yf_arena_block * prev;
+    size_t size, used;
+    max_align_t data[];
+};
+
+struct yf_arena {
+
+    /* The block being allocated from - the others are only kept to be freed. */
+    struct yf_arena_block * current;
+
+    /* Bytes handed out, and bytes taken from malloc, over all blocks. */
+    size_t used, reserved;
+
+};
+
+/**
+ * Initialize an empty arena. No memory is taken until the first allocation.
+ */
+void yf_arena_init(struct yf_arena *);
+
+/**
+ * Allocate uninitialized memory, aligned for any type. Returns NULL only if
+ * memory runs out.
+ */
+void * yf_arena_alloc(struct yf_arena *, size_t size);
+
+/**
+ * Free every block of the arena. Safe to call on a zeroed arena.
+ */
+void yf_arena_destroy(struct yf_arena *);
+
+#endif /* UTIL_ARENA_H */
@@ -0,0 +1,92 @@
+#include "hash.h"
+
+#include <string.h>
+
+#define P1 11400714785074694791u
+#define P2 14029467366897019727u
+#define P3 1609587929392839161u
+#define P4 9650029242287828579u
+#define P5 2870177450012600261u
+
+static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/* Reads are unaligned, and assume a little-endian machine. */
+static inline uint64_t read64(const unsigned char * p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char * p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+static inline uint64_t merge64(uint64_t acc, uint64_t val) {
+    acc ^= round64(0, val);
+    return acc * P1 + P4;
+}
+
+uint64_t yf_hash(const void * data, size_t len, uint64_t seed) {
+
+    const unsigned char * p = data, * end = p + len;
+    uint64_t h, v1, v2, v3, v4;
+
+    if (len >= 32) {
+        v1 = seed + P1 + P2;
+        v2 = seed + P2;
+        v3 = seed;
+        v4 = seed - P1;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge64(h, v1);
+        h = merge64(h, v2);
+        h = merge64(h, v3);
+        h = merge64(h, v4);
+    } else {
+        h = seed + P5;
+    }
+
+    h += len;
+
+    for (; end - p >= 8; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+    }
+    if (end - p >= 4) {
+        h ^= read32(p) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= *p * P5;
+        h = rotl(h, 11) * P1;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+
+}
+
+uint64_t yf_hash_str(const char * str, uint64_t seed) {
+    return yf_hash(str, strlen(str) + 1, seed);
+}
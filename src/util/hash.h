@@ -0,0 +1,26 @@
+/**
+ * A fast, non-cryptographic 64-bit hash - this is XXH64. It's used to tell
+ * whether something has changed since the last build, like a file or the
+ * flags of a command, so it needs to be fast on large inputs and stable
+ * across runs, but doesn't need to resist attacks.
+ */
+
+#ifndef UTIL_HASH_H
+#define UTIL_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Hash a block of memory. Hashes can be chained, by passing the hash of one
+ * block as the seed of the next.
+ */
+uint64_t yf_hash(const void * data, size_t len, uint64_t seed);
+
+/**
+ * Hash a string, including its terminator - so that chaining "ab", "c" gives
+ * something different from chaining "a", "bc".
+ */
+uint64_t yf_hash_str(const char * str, uint64_t seed);
+
+#endif /* UTIL_HASH_H */
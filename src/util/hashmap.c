@@ -48,12 +48,12 @@ void yfh_destroy(struct yf_hashmap * hm, void (*cleanup)(void *)) {
             bucket = bucket->next;
             if (cleanup)
                 cleanup(last->value);
-            free(last->key);
-            free(last);
+            yf_free(last->key);
+            yf_free(last);
         }
     }
 
-    free(hm->buckets);
+    yf_free(hm->buckets);
 
 }
 
@@ -95,8 +95,8 @@ int yfh_remove(struct yf_hashmap * hm, const char * key, void (*cleanup)(void *)
     if (cleanup)
         cleanup(bucket->value);
     *cursor.position = bucket->next;
-    free(bucket->key);
-    free(bucket);
+    yf_free(bucket->key);
+    yf_free(bucket);
     return 0;
 
 }
@@ -121,8 +121,8 @@ int yfh_remove_at(struct yfh_cursor * cur, void (*cleanup)(void *)) {
         cleanup(bucket->value);
     *before_ptr = bucket->next;
     cur->current = *before_ptr;
-    free(bucket->key);
-    free(bucket);
+    yf_free(bucket->key);
+    yf_free(bucket);
     return 0;
 }
 
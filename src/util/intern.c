@@ -0,0 +1,33 @@
+#include "intern.h"
+
+#include <util/allocator.h>
+
+int yf_intern_init(struct yf_intern_table * table) {
+    yfh_init(&table->strings);
+    return table->strings.buckets == NULL;
+}
+
+const char * yf_intern(struct yf_intern_table * table, const char * str) {
+
+    char * interned;
+
+    if (yfh_get(&table->strings, str, (void **) &interned) == 0)
+        return interned;
+
+    interned = yf_strdup(str);
+    if (!interned)
+        return NULL;
+
+    if (yfh_set(&table->strings, str, interned)) {
+        yf_free(interned);
+        return NULL;
+    }
+
+    return interned;
+
+}
+
+void yf_intern_destroy(struct yf_intern_table * table) {
+    if (table->strings.buckets)
+        yfh_destroy(&table->strings, yf_free);
+}
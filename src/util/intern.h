@@ -0,0 +1,35 @@
+/**
+ * A string interner. Every distinct string is stored once, and interning the
+ * same string again returns the same pointer - so interned strings can be
+ * compared by address, and outlive whatever buffer they were copied from.
+ */
+
+#ifndef UTIL_INTERN_H
+#define UTIL_INTERN_H
+
+#include <util/hashmap.h>
+
+struct yf_intern_table {
+
+    /* Key and value are the same string - the value is the interned copy. */
+    struct yf_hashmap strings;
+
+};
+
+/**
+ * Initialize an interner. Returns 0 on success, 1 on failure.
+ */
+int yf_intern_init(struct yf_intern_table *);
+
+/**
+ * Get the interned copy of a string, adding it if needed. Returns NULL only if
+ * memory runs out.
+ */
+const char * yf_intern(struct yf_intern_table *, const char * str);
+
+/**
+ * Free the interner and every string in it. Safe to call on a zeroed interner.
+ */
+void yf_intern_destroy(struct yf_intern_table *);
+
+#endif /* UTIL_INTERN_H */
@@ -0,0 +1,165 @@
+#include "profile.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <util/allocator.h>
+
+/* How many units are listed in the report. */
+#define YF_PROFILE_SLOWEST_UNITS 10
+
+bool yf_profiling = false;
+
+static uint64_t yf_profile_start;
+
+static _Atomic uint64_t yf_phase_ns[YF_PHASE_COUNT];
+static _Atomic uint64_t yf_phase_spans[YF_PHASE_COUNT];
+
+static const char * const yf_phase_names[YF_PHASE_COUNT] = {
+    [YF_PHASE_LEX]      = "lex",
+    [YF_PHASE_PARSE]    = "parse",
+    [YF_PHASE_SYMTAB]   = "symtab",
+    [YF_PHASE_INDEX]    = "index",
+    [YF_PHASE_VALIDATE] = "validate",
+    [YF_PHASE_FOLD]     = "fold",
+    [YF_PHASE_CODEGEN]  = "codegen",
+    [YF_PHASE_CC]       = "cc",
+    [YF_PHASE_LINK]     = "link",
+};
+
+void yf_profile_enable(void) {
+    yf_profiling = true;
+    yf_profile_start = yf_profile_now();
+}
+
+uint64_t yf_profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+void yf_profile_add(
+    struct yf_profile_unit * unit, enum yf_profile_phase phase, uint64_t ns
+) {
+
+    if (!yf_profiling)
+        return;
+
+    atomic_fetch_add_explicit(&yf_phase_ns[phase], ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&yf_phase_spans[phase], 1, memory_order_relaxed);
+    if (unit)
+        unit->ns[phase] += ns;
+
+}
+
+void yf_profile_end(
+    struct yf_profile_unit * unit, enum yf_profile_phase phase, uint64_t start
+) {
+    if (yf_profiling)
+        yf_profile_add(unit, phase, yf_profile_now() - start);
+}
+
+const char * yf_profile_phase_name(enum yf_profile_phase phase) {
+    return yf_phase_names[phase];
+}
+
+static uint64_t yf_profile_unit_total(const struct yf_profile_unit * unit) {
+    uint64_t total = 0;
+    int phase;
+    for (phase = 0; phase < YF_PHASE_COUNT; ++phase)
+        total += unit->ns[phase];
+    return total;
+}
+
+static int yf_profile_cmp_phases(const void * a, const void * b) {
+    uint64_t x = atomic_load(&yf_phase_ns[*(const int *) a]);
+    uint64_t y = atomic_load(&yf_phase_ns[*(const int *) b]);
+    return (x < y) - (x > y);
+}
+
+static int yf_profile_cmp_units(const void * a, const void * b) {
+    uint64_t x = yf_profile_unit_total(*(struct yf_profile_unit * const *) a);
+    uint64_t y = yf_profile_unit_total(*(struct yf_profile_unit * const *) b);
+    return (x < y) - (x > y);
+}
+
+/**
+ * Print a rate per second, or a dash if nothing was measured.
+ */
+static void yf_profile_print_rate(FILE * out, unsigned long count, double s) {
+    if (count == 0 || s <= 0)
+        fprintf(out, " %12s", "-");
+    else
+        fprintf(out, " %12.0f", count / s);
+}
+
+void yf_profile_report(
+    FILE * out, struct yf_profile_unit * const * units, size_t num_units
+) {
+
+    int order[YF_PHASE_COUNT];
+    int phase;
+    size_t i;
+    unsigned long lines = 0, tokens = 0, nodes = 0;
+    uint64_t wall = yf_profile_now() - yf_profile_start, ns;
+    struct yf_profile_unit ** sorted;
+    double s;
+
+    for (i = 0; i < num_units; ++i) {
+        lines += units[i]->lines;
+        tokens += units[i]->tokens;
+        nodes += units[i]->nodes;
+    }
+
+    for (phase = 0; phase < YF_PHASE_COUNT; ++phase)
+        order[phase] = phase;
+    qsort(order, YF_PHASE_COUNT, sizeof order[0], yf_profile_cmp_phases);
+
+    fprintf(out,
+        "Profile: %zu units, %lu lines, %lu tokens, %lu nodes, "
+        "%.3f s wall\n",
+        num_units, lines, tokens, nodes, wall / 1e9
+    );
+    fprintf(out, "%-10s %10s %7s %7s %12s %12s %12s\n",
+        "phase", "time (ms)", "%", "spans", "lines/s", "tokens/s", "nodes/s"
+    );
+
+    for (i = 0; i < YF_PHASE_COUNT; ++i) {
+        phase = order[i];
+        ns = atomic_load(&yf_phase_ns[phase]);
+        if (atomic_load(&yf_phase_spans[phase]) == 0)
+            continue;
+        s = ns / 1e9;
+        fprintf(out, "%-10s %10.2f %6.1f%% %7lu",
+            yf_phase_names[phase], ns / 1e6,
+            wall ? 100.0 * ns / wall : 0.0,
+            (unsigned long) atomic_load(&yf_phase_spans[phase])
+        );
+        yf_profile_print_rate(out, lines, s);
+        yf_profile_print_rate(out, tokens, s);
+        yf_profile_print_rate(out, nodes, s);
+        fputc('\n', out);
+    }
+
+    if (num_units == 0)
+        return;
+
+    /* Sort a copy, so the caller's order is left alone. */
+    sorted = yf_malloc(num_units * sizeof *sorted);
+    if (!sorted)
+        return;
+    for (i = 0; i < num_units; ++i)
+        sorted[i] = units[i];
+    qsort(sorted, num_units, sizeof *sorted, yf_profile_cmp_units);
+
+    fprintf(out, "Slowest units:\n");
+    for (i = 0; i < num_units && i < YF_PROFILE_SLOWEST_UNITS; ++i) {
+        fprintf(out, "%10.2f ms  %s\n",
+            yf_profile_unit_total(sorted[i]) / 1e6, sorted[i]->name
+        );
+    }
+
+    yf_free(sorted);
+
+}
@@ -0,0 +1,86 @@
+/**
+ * A profiler for the phases of a build. Code is timed in spans - a span starts
+ * with yf_profile_begin, and yf_profile_end adds its length to a phase, both for
+ * a unit and for the whole build. Spans are always compiled in: when profiling
+ * is off, each one costs a single branch.
+ *
+ * Build totals are updated with atomic adds, so spans can be ended from any
+ * thread. A unit's own numbers are not - only one thread may work on a given
+ * unit at a time.
+ */
+
+#ifndef UTIL_PROFILE_H
+#define UTIL_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum yf_profile_phase {
+    YF_PHASE_LEX,
+    YF_PHASE_PARSE,
+    YF_PHASE_SYMTAB,
+    YF_PHASE_INDEX,
+    YF_PHASE_VALIDATE,
+    YF_PHASE_FOLD,
+    YF_PHASE_CODEGEN,
+    YF_PHASE_CC,
+    YF_PHASE_LINK,
+    YF_PHASE_COUNT
+};
+
+/**
+ * Time spent on one unit, and how much work the unit is - throughput is
+ * measured against these counts.
+ */
+struct yf_profile_unit {
+    const char * name;
+    uint64_t ns[YF_PHASE_COUNT];
+    unsigned long lines, tokens, nodes;
+};
+
+/* Set once, before any spans - read-only after that. */
+extern bool yf_profiling;
+
+/**
+ * Turn profiling on. The build's wall time is measured from here.
+ */
+void yf_profile_enable(void);
+
+/**
+ * Nanoseconds on a monotonic clock.
+ */
+uint64_t yf_profile_now(void);
+
+static inline uint64_t yf_profile_begin(void) {
+    return yf_profiling ? yf_profile_now() : 0;
+}
+
+/**
+ * End a span started at 'start'. The unit may be NULL for work that isn't
+ * done for a single unit, like linking.
+ */
+void yf_profile_end(
+    struct yf_profile_unit * unit, enum yf_profile_phase phase, uint64_t start
+);
+
+/**
+ * Add time that was measured some other way - for example, summed up over many
+ * small spans, which is how the lexer is timed.
+ */
+void yf_profile_add(
+    struct yf_profile_unit * unit, enum yf_profile_phase phase, uint64_t ns
+);
+
+const char * yf_profile_phase_name(enum yf_profile_phase phase);
+
+/**
+ * Print a table of all phases, slowest first, with the throughput of each,
+ * followed by the slowest units.
+ */
+void yf_profile_report(
+    FILE * out, struct yf_profile_unit * const * units, size_t num_units
+);
+
+#endif /* UTIL_PROFILE_H */
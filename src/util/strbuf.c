@@ -0,0 +1,67 @@
+#include "strbuf.h"
+
+#include <util/allocator.h>
+
+/* The smallest allocation - most outputs are at least a few kilobytes. */
+#define YF_STRBUF_MIN_CAP 4096
+
+void yf_strbuf_init(struct yf_strbuf * buf) {
+    buf->data = NULL;
+    buf->len = buf->cap = 0;
+    buf->failed = false;
+}
+
+void yf_strbuf_destroy(struct yf_strbuf * buf) {
+    yf_free(buf->data);
+    yf_strbuf_init(buf);
+}
+
+bool yf_strbuf_reserve(struct yf_strbuf * buf, size_t more) {
+
+    size_t cap = buf->cap ? buf->cap : YF_STRBUF_MIN_CAP;
+    char * data;
+
+    if (buf->failed)
+        return false;
+    if (buf->cap - buf->len >= more)
+        return true;
+
+    while (cap - buf->len < more)
+        cap *= 2;
+
+    if (!(data = yf_realloc(buf->data, cap))) {
+        buf->failed = true;
+        return false;
+    }
+
+    buf->data = data;
+    buf->cap = cap;
+    return true;
+
+}
+
+void yf_strbuf_put_int(struct yf_strbuf * buf, long long value) {
+
+    /* Written backwards, from the last digit. */
+    char digits[24], * p = digits + sizeof digits;
+    unsigned long long mag = value < 0 ? -(unsigned long long) value : value;
+
+    do {
+        *--p = '0' + mag % 10;
+        mag /= 10;
+    } while (mag);
+    if (value < 0)
+        *--p = '-';
+
+    yf_strbuf_append(buf, p, digits + sizeof digits - p);
+
+}
+
+void yf_strbuf_indent(struct yf_strbuf * buf, int depth) {
+
+    if (depth <= 0 || !yf_strbuf_reserve(buf, depth))
+        return;
+    memset(buf->data + buf->len, '\t', depth);
+    buf->len += depth;
+
+}
@@ -0,0 +1,69 @@
+/**
+ * A growable string buffer, for output that's built up from many small pieces
+ * - like generated code - and then used all at once. Appending is a copy into
+ * memory, without any of the locking and formatting of stdio.
+ *
+ * Running out of memory doesn't stop appends from being called: the buffer
+ * just remembers that it failed, like ferror() for a stream, so callers only
+ * need to check once at the end.
+ */
+
+#ifndef UTIL_STRBUF_H
+#define UTIL_STRBUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * A zeroed buffer is a valid, empty buffer. The data is not null-terminated.
+ */
+struct yf_strbuf {
+    char * data;
+    size_t len, cap;
+    bool failed;
+};
+
+void yf_strbuf_init(struct yf_strbuf *);
+
+/**
+ * Free the buffer. It's left empty, and can be reused.
+ */
+void yf_strbuf_destroy(struct yf_strbuf *);
+
+/**
+ * Make room for at least 'more' bytes after the end. Returns false (and marks
+ * the buffer as failed) if we've run out of memory.
+ */
+bool yf_strbuf_reserve(struct yf_strbuf *, size_t more);
+
+static inline void yf_strbuf_append(
+    struct yf_strbuf * buf, const char * data, size_t len
+) {
+    if (buf->cap - buf->len < len && !yf_strbuf_reserve(buf, len))
+        return;
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static inline void yf_strbuf_puts(struct yf_strbuf * buf, const char * str) {
+    yf_strbuf_append(buf, str, strlen(str));
+}
+
+static inline void yf_strbuf_putc(struct yf_strbuf * buf, char c) {
+    if (buf->len == buf->cap && !yf_strbuf_reserve(buf, 1))
+        return;
+    buf->data[buf->len++] = c;
+}
+
+/**
+ * Append a number in decimal.
+ */
+void yf_strbuf_put_int(struct yf_strbuf *, long long value);
+
+/**
+ * Append 'depth' tabs.
+ */
+void yf_strbuf_indent(struct yf_strbuf *, int depth);
+
+#endif /* UTIL_STRBUF_H */
@@ -0,0 +1,58 @@
+#include "vec.h"
+
+#include <string.h>
+
+#include <util/allocator.h>
+
+void yf_vec_init(struct yf_vec * vec) {
+    vec->count = 0;
+    vec->capacity = 0;
+}
+
+int yf_vec_add(struct yf_vec * vec, void * element) {
+
+    void ** data;
+    uint32_t capacity;
+
+    if (vec->count < YF_VEC_INLINE) {
+        /* Still fits inline. */
+        if (vec->capacity < YF_VEC_INLINE)
+            vec->capacity = YF_VEC_INLINE;
+    } else if (vec->count == vec->capacity) {
+        /* Full - move to a heap array twice the size. */
+        capacity = vec->capacity * 2;
+        if (vec->capacity == YF_VEC_INLINE) {
+            data = yf_malloc(capacity * sizeof (void *));
+            if (!data)
+                return -1;
+            memcpy(data, vec->inline_data, sizeof vec->inline_data);
+        } else {
+            data = yf_realloc(vec->data, capacity * sizeof (void *));
+            if (!data)
+                return -1;
+        }
+        vec->data = data;
+        vec->capacity = capacity;
+    }
+
+    yf_vec_data(vec)[vec->count++] = element;
+    return 0;
+
+}
+
+void yf_vec_destroy(struct yf_vec * vec, int free_elements) {
+
+    void * element;
+
+    if (free_elements) {
+        YF_VEC_FOREACH(*vec, element) {
+            yf_free(element);
+        }
+    }
+
+    if (vec->capacity > YF_VEC_INLINE)
+        yf_free(vec->data);
+
+    yf_vec_init(vec);
+
+}
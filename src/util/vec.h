@@ -0,0 +1,80 @@
+/**
+ * A growable array of pointers. Most lists of children in a tree are short -
+ * a call with one argument, a function with no parameters - so the first few
+ * elements are stored in the vector itself, and memory is only allocated once
+ * it outgrows that.
+ */
+
+#ifndef UTIL_VEC_H
+#define UTIL_VEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* How many elements fit in the vector before it needs to allocate. */
+#define YF_VEC_INLINE 4
+
+/**
+ * A zeroed vector is a valid, empty vector.
+ */
+struct yf_vec {
+
+    uint32_t count;
+
+    /* At most YF_VEC_INLINE means the elements are stored inline. */
+    uint32_t capacity;
+
+    union {
+        void * inline_data[YF_VEC_INLINE];
+        void ** data;
+    };
+
+};
+
+/**
+ * Initialize an empty vector. Doesn't allocate anything.
+ */
+void yf_vec_init(struct yf_vec * vec);
+
+/**
+ * Get a pointer to the first element. Only valid until the next add.
+ */
+static inline void ** yf_vec_data(struct yf_vec * vec) {
+    return vec->capacity > YF_VEC_INLINE ? vec->data : vec->inline_data;
+}
+
+static inline size_t yf_vec_count(const struct yf_vec * vec) {
+    return vec->count;
+}
+
+/**
+ * Get an element by index - the index must be less than the count.
+ */
+static inline void * yf_vec_get(struct yf_vec * vec, size_t index) {
+    return yf_vec_data(vec)[index];
+}
+
+/**
+ * Add an element. Returns -1 if we've run out of memory, or 0 otherwise.
+ */
+int yf_vec_add(struct yf_vec * vec, void * element);
+
+/**
+ * Destroy a vector, optionally freeing every element. The vector is left
+ * empty, and can be reused.
+ */
+void yf_vec_destroy(struct yf_vec * vec, int free_elements);
+
+/**
+ * Unlike YF_LIST_FOREACH, this declares nothing outside of the loop, so it can
+ * be used any number of times in a scope, and nested.
+ * @param vec must be an lvalue that is safe to evaluate multiple times (like a variable)
+ * @param out an lvalue denoting the element
+ */
+#define YF_VEC_FOREACH(vec, out) \
+    for (void ** YF_VEC_IT = yf_vec_data(&(vec)); \
+        YF_VEC_IT < yf_vec_data(&(vec)) + (vec).count \
+            && ((out) = *YF_VEC_IT, 1); \
+        ++YF_VEC_IT)
+
+#endif /* UTIL_VEC_H */